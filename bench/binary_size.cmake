@@ -0,0 +1,43 @@
+# Records the size of every binary in BINARIES, as built and, when STRIP is given, stripped.
+#
+#   cmake -DBINARIES=<name>=<path>,... -DWORK_DIR=<dir> -DOUTPUT=<json> [-DSTRIP=<strip>]
+#         -P binary_size.cmake
+cmake_minimum_required(VERSION 3.16)
+
+foreach(required BINARIES WORK_DIR OUTPUT)
+    if(NOT DEFINED ${required})
+        message(FATAL_ERROR "binary_size.cmake: ${required} is not set")
+    endif()
+endforeach()
+
+string(REPLACE "," ";" BINARIES "${BINARIES}")
+file(MAKE_DIRECTORY ${WORK_DIR})
+set(results)
+
+foreach(binary IN LISTS BINARIES)
+    string(FIND "${binary}" "=" separator)
+    string(SUBSTRING "${binary}" 0 ${separator} name)
+    math(EXPR separator "${separator} + 1")
+    string(SUBSTRING "${binary}" ${separator} -1 path)
+
+    file(SIZE ${path} bytes)
+    set(entry "    { \"name\": \"${name}\", \"bytes\": ${bytes}")
+
+    if(STRIP)
+        set(stripped ${WORK_DIR}/${name}.stripped)
+        execute_process(COMMAND ${STRIP} -o ${stripped} ${path} RESULT_VARIABLE failed)
+        if(failed)
+            message(FATAL_ERROR "binary_size.cmake: could not strip ${path}")
+        endif()
+        file(SIZE ${stripped} stripped_bytes)
+        string(APPEND entry ", \"stripped_bytes\": ${stripped_bytes}")
+        message(STATUS "${name}: ${bytes} bytes, ${stripped_bytes} stripped")
+    else()
+        message(STATUS "${name}: ${bytes} bytes")
+    endif()
+
+    list(APPEND results "${entry} }")
+endforeach()
+
+list(JOIN results ",\n" entries)
+file(WRITE ${OUTPUT} "{\n  \"binaries\": [\n${entries}\n  ]\n}\n")
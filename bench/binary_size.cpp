@@ -0,0 +1,68 @@
+// The same graph of wired services, resolved through cpp_di or, with
+// CPP_DI_BINARY_SIZE_BASELINE, wired by hand. Built in several configurations by
+// bench/CMakeLists.txt, whose binary_size_report target records the size of each.
+
+#include <cpp_di.hpp>
+
+#include <memory>
+#include <utility>
+
+namespace
+{
+    constexpr int services = 32;
+
+    // Service N takes services N - 1 and N / 2, like the compile-time benchmark.
+    template<int N>
+    struct service
+    {
+        std::shared_ptr<service<N - 1>> previous;
+        std::shared_ptr<service<N / 2>> half;
+
+        service(std::shared_ptr<service<N - 1>> previous, std::shared_ptr<service<N / 2>> half)
+            : previous(std::move(previous)), half(std::move(half))
+        {
+        }
+    };
+
+    template<>
+    struct service<0> { int value = 0; };
+
+#ifdef CPP_DI_BINARY_SIZE_BASELINE
+    template<int N>
+    std::shared_ptr<service<N>> wire(std::shared_ptr<void> (&built)[services])
+    {
+        auto& slot = built[N];
+        if (!slot)
+        {
+            if constexpr (N == 0)
+            {
+                slot = std::make_shared<service<0>>();
+            }
+            else
+            {
+                slot = std::make_shared<service<N>>(wire<N - 1>(built), wire<N / 2>(built));
+            }
+        }
+        return std::static_pointer_cast<service<N>>(slot);
+    }
+#else
+    template<int... N>
+    void register_services(std::integer_sequence<int, N...>)
+    {
+        (cpp_di::di::add<service<N>>(), ...);
+    }
+#endif
+}
+
+int main()
+{
+#ifdef CPP_DI_BINARY_SIZE_BASELINE
+    std::shared_ptr<void> built[services];
+    return wire<services - 1>(built) ? 0 : 1;
+#else
+    // Registered from a template, so set_type has to be seen here for di::get below.
+    cpp_di::type_registry::set_type<service<services - 1>>();
+    register_services(std::make_integer_sequence<int, services>());
+    return cpp_di::di::get<service<services - 1>>() ? 0 : 1;
+#endif
+}
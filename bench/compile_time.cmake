@@ -0,0 +1,108 @@
+# Measures the front-end cost per registered service: for every count in COUNTS, generates a
+# translation unit registering that many wired services and times its front end alone
+# (-fsyntax-only, GCC and Clang), once with constructor arity probed through refl::as_tuple and
+# once with `using inject = ...` hints.
+#
+#   cmake -DCOMPILER=<c++> -DCOMPILER_ID=<id> -DINCLUDE_DIR=<repo> -DWORK_DIR=<dir>
+#         -DOUTPUT=<json> [-DCOUNTS=10,25,50] [-DREPETITIONS=3] -P compile_time.cmake
+#
+# Writes the fastest of REPETITIONS runs of each translation unit to OUTPUT as JSON.
+cmake_minimum_required(VERSION 3.23)
+
+foreach(required COMPILER COMPILER_ID INCLUDE_DIR WORK_DIR OUTPUT)
+    if(NOT DEFINED ${required})
+        message(FATAL_ERROR "compile_time.cmake: ${required} is not set")
+    endif()
+endforeach()
+
+if(NOT DEFINED COUNTS)
+    set(COUNTS 10,25,50)
+endif()
+string(REPLACE "," ";" COUNTS "${COUNTS}")
+if(NOT DEFINED REPETITIONS)
+    set(REPETITIONS 3)
+endif()
+
+set(flags -std=c++20 -fsyntax-only -I${INCLUDE_DIR})
+if(COMPILER_ID STREQUAL "GNU")
+    list(APPEND flags -Wno-non-template-friend)
+endif()
+
+# Service i takes services i - 1 and i / 2, so the graph is neither a plain chain nor flat.
+function(generate file count hinted)
+    set(source "#include <cpp_di.hpp>\n\nusing namespace cpp_di;\n\nstruct s0 {};\n")
+    math(EXPR last "${count} - 1")
+    foreach(i RANGE 1 ${last})
+        math(EXPR previous "${i} - 1")
+        math(EXPR half "${i} / 2")
+        set(parameters "std::shared_ptr<s${previous}>, std::shared_ptr<s${half}>")
+        string(APPEND source "\nstruct s${i}\n{\n")
+        if(hinted)
+            string(APPEND source "    using inject = std::tuple<${parameters}>;\n")
+        endif()
+        string(APPEND source "    s${i}(${parameters}) {}\n};\n")
+    endforeach()
+
+    string(APPEND source "\nint main()\n{\n")
+    foreach(i RANGE 0 ${last})
+        string(APPEND source "    di::add<s${i}>();\n")
+    endforeach()
+    string(APPEND source "    return di::get<s${last}>() ? 0 : 1;\n}\n")
+    file(WRITE ${file} "${source}")
+endfunction()
+
+function(now result)
+    string(TIMESTAMP stamp "%s%f" UTC)
+    set(${result} ${stamp} PARENT_SCOPE)
+endfunction()
+
+# Fastest of REPETITIONS front-end runs over source, in microseconds.
+function(measure result source)
+    set(best "")
+    foreach(repetition RANGE 1 ${REPETITIONS})
+        now(begin)
+        execute_process(
+            COMMAND ${COMPILER} ${flags} ${source}
+            RESULT_VARIABLE failed
+            ERROR_VARIABLE errors)
+        now(end)
+        if(failed)
+            message(FATAL_ERROR "compile_time.cmake: ${source} failed to compile:\n${errors}")
+        endif()
+        math(EXPR elapsed "${end} - ${begin}")
+        if(best STREQUAL "" OR elapsed LESS best)
+            set(best ${elapsed})
+        endif()
+    endforeach()
+    set(${result} ${best} PARENT_SCOPE)
+endfunction()
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+# The header alone, subtracted from every measurement so that the per-service figure is the
+# marginal cost of a registration.
+file(WRITE ${WORK_DIR}/baseline.cpp "#include <cpp_di.hpp>\n\nint main() { return 0; }\n")
+measure(baseline ${WORK_DIR}/baseline.cpp)
+message(STATUS "header alone: ${baseline} us")
+
+set(results)
+foreach(count IN LISTS COUNTS)
+    foreach(mode probed inject)
+        if(mode STREQUAL "inject")
+            set(hinted ON)
+        else()
+            set(hinted OFF)
+        endif()
+
+        set(source ${WORK_DIR}/${mode}_${count}.cpp)
+        generate(${source} ${count} ${hinted})
+        measure(best ${source})
+
+        math(EXPR per_service "(${best} - ${baseline}) / ${count}")
+        message(STATUS "${mode} x${count}: ${best} us, ${per_service} us per service")
+        list(APPEND results "    { \"mode\": \"${mode}\", \"services\": ${count}, \"microseconds\": ${best}, \"microseconds_per_service\": ${per_service} }")
+    endforeach()
+endforeach()
+
+list(JOIN results ",\n" entries)
+file(WRITE ${OUTPUT} "{\n  \"compiler\": \"${COMPILER_ID}\",\n  \"repetitions\": ${REPETITIONS},\n  \"header_microseconds\": ${baseline},\n  \"results\": [\n${entries}\n  ]\n}\n")
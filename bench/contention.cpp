@@ -0,0 +1,129 @@
+#include <benchmark/benchmark.h>
+
+#include <cpp_di.hpp>
+
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace cpp_di;
+
+namespace
+{
+    struct config { int value = 1; };
+
+    struct service
+    {
+        std::shared_ptr<config> cfg;
+
+        service(std::shared_ptr<config> cfg) : cfg(std::move(cfg)) {}
+    };
+
+    [[maybe_unused]] const bool registered = []
+    {
+        di::add<config>();
+        di::add<service>();
+        return true;
+    }();
+
+    // Stands in for the constructor of a cold singleton.
+    void construct()
+    {
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(50);
+        while (std::chrono::steady_clock::now() < until)
+        {
+        }
+    }
+
+    void run_once(internal::once_flag& flag) { internal::call_once(flag, &construct); }
+    void run_once(std::once_flag& flag) { std::call_once(flag, &construct); }
+
+    // Every iteration releases state.range(0) threads on a fresh flag at once and measures
+    // until the last of them is through: the pile-up behind the first access to a cold
+    // singleton.
+    template<typename FLAG_T>
+    void once_cold(benchmark::State& state)
+    {
+        const auto count = static_cast<std::ptrdiff_t>(state.range(0));
+        std::unique_ptr<FLAG_T> flag;
+        std::barrier start(count + 1), finish(count + 1);
+        bool stop = false;
+
+        std::vector<std::thread> workers;
+        for (std::ptrdiff_t i = 0; i < count; i++)
+        {
+            workers.emplace_back([&]()
+            {
+                while (true)
+                {
+                    start.arrive_and_wait();
+                    if (stop)
+                    {
+                        return;
+                    }
+                    run_once(*flag);
+                    finish.arrive_and_wait();
+                }
+            });
+        }
+
+        for (auto _ : state)
+        {
+            flag = std::make_unique<FLAG_T>();
+            auto begin = std::chrono::steady_clock::now();
+            start.arrive_and_wait();
+            finish.arrive_and_wait();
+            state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+        }
+
+        stop = true;
+        start.arrive_and_wait();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    // Calls on a flag that has already completed, from every benchmark thread at once.
+    template<typename FLAG_T>
+    void once_hot(benchmark::State& state)
+    {
+        static FLAG_T flag;
+        run_once(flag);
+        for (auto _ : state)
+        {
+            run_once(flag);
+            benchmark::ClobberMemory();
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(once_cold, internal::once_flag)->RangeMultiplier(4)->Range(4, 256)->UseManualTime();
+BENCHMARK_TEMPLATE(once_cold, std::once_flag)->RangeMultiplier(4)->Range(4, 256)->UseManualTime();
+
+BENCHMARK_TEMPLATE(once_hot, internal::once_flag)->ThreadRange(1, 256)->UseRealTime();
+BENCHMARK_TEMPLATE(once_hot, std::once_flag)->ThreadRange(1, 256)->UseRealTime();
+
+static void get_contended(benchmark::State& state)
+{
+    di::get<service>();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(di::get<service>());
+    }
+}
+BENCHMARK(get_contended)->ThreadRange(1, 256)->UseRealTime();
+
+static void get_ptr_contended(benchmark::State& state)
+{
+    di::get<service>();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(di::get_ptr<service>());
+    }
+}
+BENCHMARK(get_ptr_contended)->ThreadRange(1, 256)->UseRealTime();
@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+
+#include <cpp_di.hpp>
+
+#include <memory>
+#include <thread>
+#include <utility>
+
+using namespace cpp_di;
+
+namespace
+{
+    // Hot path: singletons that are already constructed.
+
+    struct config { int value = 1; };
+
+    struct service
+    {
+        std::shared_ptr<config> cfg;
+
+        service(std::shared_ptr<config> cfg) : cfg(std::move(cfg)) {}
+    };
+
+    // First-time construction: a chain of DEPTH types, each wired to the previous one,
+    // and a root wired to WIDTH independent leaves.
+
+    constexpr int depth = 16;
+
+    template<int N>
+    struct chain
+    {
+        std::shared_ptr<chain<N - 1>> next;
+
+        chain(std::shared_ptr<chain<N - 1>> next) : next(std::move(next)) {}
+    };
+
+    template<>
+    struct chain<0> { int value = 0; };
+
+    template<int N>
+    struct leaf { int value = N; };
+
+    struct wide_root
+    {
+        std::shared_ptr<leaf<0>> l0; std::shared_ptr<leaf<1>> l1; std::shared_ptr<leaf<2>> l2; std::shared_ptr<leaf<3>> l3;
+        std::shared_ptr<leaf<4>> l4; std::shared_ptr<leaf<5>> l5; std::shared_ptr<leaf<6>> l6; std::shared_ptr<leaf<7>> l7;
+
+        wide_root(std::shared_ptr<leaf<0>> l0, std::shared_ptr<leaf<1>> l1, std::shared_ptr<leaf<2>> l2, std::shared_ptr<leaf<3>> l3,
+                  std::shared_ptr<leaf<4>> l4, std::shared_ptr<leaf<5>> l5, std::shared_ptr<leaf<6>> l6, std::shared_ptr<leaf<7>> l7)
+            : l0(std::move(l0)), l1(std::move(l1)), l2(std::move(l2)), l3(std::move(l3))
+            , l4(std::move(l4)), l5(std::move(l5)), l6(std::move(l6)), l7(std::move(l7))
+        {
+        }
+    };
+
+    // Transient registrations: default-constructible against auto-wired.
+
+    struct plain { int value = 0; };
+
+    struct wired
+    {
+        std::shared_ptr<config> cfg;
+
+        wired(std::shared_ptr<config> cfg) : cfg(std::move(cfg)) {}
+    };
+
+    template<int... N>
+    void register_chain(std::integer_sequence<int, N...>)
+    {
+        (di::add_transient<chain<N>>(), ...);
+    }
+
+    template<int... N>
+    void register_chain(di::container& c, std::integer_sequence<int, N...>)
+    {
+        (c.add<chain<N>>(), ...);
+    }
+
+    template<int... N>
+    void register_leaves(std::integer_sequence<int, N...>)
+    {
+        (di::add_transient<leaf<N>>(), ...);
+    }
+
+    template<int N>
+    std::shared_ptr<chain<N>> wire_chain()
+    {
+        if constexpr (N == 0)
+        {
+            return std::make_shared<chain<0>>();
+        }
+        else
+        {
+            return std::make_shared<chain<N>>(wire_chain<N - 1>());
+        }
+    }
+
+    [[maybe_unused]] const bool registered = []
+    {
+        di::add<config>();
+        di::add<service>();
+        // Types registered from a template are only visible to di::get<T>() later in this
+        // translation unit once set_type<T>() has been seen outside of one.
+        type_registry::set_type<chain<depth>>();
+        register_chain(std::make_integer_sequence<int, depth + 1>());
+        register_leaves(std::make_integer_sequence<int, 8>());
+        di::add_transient<wide_root>();
+        di::add_transient<plain>();
+        di::add_transient<wired>();
+        return true;
+    }();
+}
+
+static void get_singleton(benchmark::State& state)
+{
+    di::get<service>();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(di::get<service>());
+    }
+}
+BENCHMARK(get_singleton)->ThreadRange(1, 16)->UseRealTime();
+
+static void get_singleton_ptr(benchmark::State& state)
+{
+    di::get<service>();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(di::get_ptr<service>());
+    }
+}
+BENCHMARK(get_singleton_ptr)->ThreadRange(1, 16)->UseRealTime();
+
+static void get_hand_wired(benchmark::State& state)
+{
+    auto instance = std::make_shared<service>(std::make_shared<config>());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::shared_ptr<service>(instance));
+    }
+}
+BENCHMARK(get_hand_wired)->ThreadRange(1, 16)->UseRealTime();
+
+static void construct_deep(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(di::get<chain<depth>>());
+    }
+}
+BENCHMARK(construct_deep);
+
+static void construct_deep_container(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        di::container c;
+        register_chain(c, std::make_integer_sequence<int, depth + 1>());
+        benchmark::DoNotOptimize(c.get<chain<depth>>());
+    }
+}
+BENCHMARK(construct_deep_container);
+
+static void construct_deep_hand_wired(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(wire_chain<depth>());
+    }
+}
+BENCHMARK(construct_deep_hand_wired);
+
+static void construct_wide(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(di::get<wide_root>());
+    }
+}
+BENCHMARK(construct_wide);
+
+static void construct_wide_hand_wired(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::make_shared<wide_root>(
+            std::make_shared<leaf<0>>(), std::make_shared<leaf<1>>(), std::make_shared<leaf<2>>(), std::make_shared<leaf<3>>(),
+            std::make_shared<leaf<4>>(), std::make_shared<leaf<5>>(), std::make_shared<leaf<6>>(), std::make_shared<leaf<7>>()));
+    }
+}
+BENCHMARK(construct_wide_hand_wired);
+
+static void create_default_constructible(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(di::get<plain>());
+    }
+}
+BENCHMARK(create_default_constructible);
+
+static void create_wired(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(di::get<wired>());
+    }
+}
+BENCHMARK(create_wired);
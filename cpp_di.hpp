@@ -1,12 +1,77 @@
 #ifndef _CPP_DI
 #define _CPP_DI
 
+// Requires C++20: std::type_identity, class-type template parameters for keyed
+// registrations and std::atomic wait/notify.
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) < 202002L
+#error "cpp_di requires C++20"
+#endif
+
 #include <memory>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <memory_resource>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <cstdlib>
+#include <future>
+#include <string_view>
 #include <tuple>
 #include <utility>
 #include <mutex>
-#include <functional>
+#include <atomic>
 #include <type_traits>
+#include <chrono>
+#include <ostream>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(SYS_membarrier) && __has_include(<linux/membarrier.h>)
+#include <linux/membarrier.h>
+#define CPP_DI_MEMBARRIER
+#endif
+#endif
+
+// Cross-DSO mode: with CPP_DI_SHARED_REGISTRY defined everywhere, singletons of the
+// shared_ownership policy live in one table owned by the module that includes this header with
+// CPP_DI_EXPORT_REGISTRY defined, in exactly one translation unit.
+#ifdef CPP_DI_SHARED_REGISTRY
+#if defined(_WIN32)
+#ifdef CPP_DI_EXPORT_REGISTRY
+#define CPP_DI_REGISTRY_API __declspec(dllexport)
+#else
+#define CPP_DI_REGISTRY_API __declspec(dllimport)
+#endif
+#else
+#define CPP_DI_REGISTRY_API __attribute__((visibility("default")))
+#endif
+#endif
+
+// Without exception support (-fno-exceptions, or CPP_DI_NO_EXCEPTIONS defined) failures are
+// reported to the handler installed by di::set_failure_handler and the process aborts.
+#if !defined(CPP_DI_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(__EXCEPTIONS) && !defined(_CPPUNWIND)
+#define CPP_DI_NO_EXCEPTIONS
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CPP_DI_COLD __declspec(noinline)
+#else
+#define CPP_DI_COLD __attribute__((noinline, cold))
+#endif
+
+// Replicas kept per replicated registration; threads on higher NUMA nodes share them modulo.
+#ifndef CPP_DI_MAX_NUMA_NODES
+#define CPP_DI_MAX_NUMA_NODES 8
+#endif
 
 namespace cpp_di
 {
@@ -89,6 +154,27 @@ namespace cpp_di
 
     }  // namespace refl
 
+    // Constructor parameters injected into a non default-constructible T, as a std::tuple.
+    // By default they are discovered by refl::as_tuple, which probes every arity. Declaring
+    // `using inject = std::tuple<...>;` in T, or specializing this trait, states the signature
+    // instead and skips the probing. That saves only a few percent of compile time, most of
+    // which goes to the registration itself; the hint is mainly needed for reference
+    // parameters, which the probing cannot deduce.
+    template<typename T, typename = void>
+    struct constructor_args
+    {
+        using type = refl::as_tuple<T>;
+    };
+
+    template<typename T>
+    struct constructor_args<T, std::void_t<typename T::inject>>
+    {
+        using type = typename T::inject;
+    };
+
+    template<typename T>
+    using constructor_args_t = typename constructor_args<T>::type;
+
     namespace type_registry
     {
         template<typename>
@@ -116,135 +202,3857 @@ namespace cpp_di
         }
     }
 
-    namespace internal
+    enum class lifetime
     {
-        template<typename T> struct is_shared_ptr : std::false_type {};
-        template<typename T> struct is_shared_ptr<std::shared_ptr<T>> : std::true_type {};
-    }
+        // One instance per process, built on first use.
+        singleton,
+        // A fresh instance for every resolution.
+        transient,
+        // One instance per di::scope, allocated from the scope's arena.
+        scoped,
+        // One instance per thread, built on first use by that thread and destroyed at its exit.
+        per_thread,
+        // Instances recycled through a bounded pool, handed out by di::acquire.
+        pooled,
+        // One instance per NUMA node, built by the first thread resolving it on that node.
+        replicated
+    };
 
-    class di
+    enum class errc
     {
-        template<typename CLASS_T, typename ARGUMENT_T>
-        static void fail_type()
+        none,
+        // The type, or the interface being decorated or rebuilt, was never registered.
+        not_registered,
+        // The resolution is not supported by the registered lifetime, e.g. borrowing a transient.
+        wrong_lifetime,
+        // A scoped type was resolved while no di::scope was active.
+        outside_scope,
+        // A multi-binding was extended after it was first resolved.
+        already_resolved,
+        // Two type names hash to the same stable id in the shared registry.
+        type_id_collision,
+        // The factory of the type, or of one of its dependencies, failed.
+        construction_failed
+    };
+
+    // Thrown for every failure of the container itself.
+    class error : public std::logic_error
+    {
+        errc value;
+    public:
+        error(errc value, const char* message) : std::logic_error(message), value(value) {}
+
+        errc code() const noexcept { return value; }
+    };
+
+    using failure_handler = void (*)(errc code, const char* message);
+
+    template<typename T> class lazy;
+    template<typename T> class all;
+    template<typename T> class pooled;
+    template<typename T> class local_ptr;
+    template<typename T> class intrusive_ptr;
+
+    namespace internal
+    {
+        template<typename T> struct is_lazy : std::false_type {};
+        template<typename T> struct is_lazy<lazy<T>> : std::true_type {};
+
+        template<typename T> struct is_all : std::false_type {};
+        template<typename T> struct is_all<all<T>> : std::true_type {};
+
+        template<typename T> struct is_pooled : std::false_type {};
+        template<typename T> struct is_pooled<pooled<T>> : std::true_type {};
+
+        // Pointer types an ownership policy may hand out, see pointer_policy.
+        template<typename T> struct is_policy_pointer : std::false_type {};
+        template<typename T> struct is_policy_pointer<std::shared_ptr<T>> : std::true_type {};
+        template<typename T> struct is_policy_pointer<local_ptr<T>> : std::true_type {};
+        template<typename T> struct is_policy_pointer<intrusive_ptr<T>> : std::true_type {};
+
+        template<typename T> struct is_unique_ptr : std::false_type {};
+        template<typename T> struct is_unique_ptr<std::unique_ptr<T>> : std::true_type {};
+
+        template<typename T, typename = void> struct has_use_count : std::false_type {};
+        template<typename T> struct has_use_count<T, std::void_t<decltype(std::declval<const T&>().use_count())>> : std::true_type {};
+
+        // Registered type a constructor parameter is wired from, void for parameters that are
+        // not an edge of the graph.
+        template<typename T, typename = void> struct dependency_type { using type = void; };
+        template<typename T> struct dependency_type<std::shared_ptr<T>> { using type = T; };
+        template<typename T> struct dependency_type<local_ptr<T>> { using type = T; };
+        template<typename T> struct dependency_type<intrusive_ptr<T>> { using type = T; };
+        template<typename T> struct dependency_type<std::unique_ptr<T>> { using type = T; };
+        template<typename T> struct dependency_type<T*> { using type = std::remove_cv_t<T>; };
+        template<typename T> struct dependency_type<T&> { using type = std::remove_cv_t<T>; };
+
+        // Human readable name of T, extracted from the signature of this function at compile time.
+        template<typename T>
+        constexpr std::string_view type_name()
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            constexpr std::string_view signature = __FUNCSIG__;
+            constexpr auto begin = signature.find("type_name<") + std::string_view("type_name<").size();
+            constexpr auto end = signature.rfind(">(void)");
+#else
+            // GCC: "... [with T = A; std::string_view = ...]", clang: "... [T = A]".
+            constexpr std::string_view signature = __PRETTY_FUNCTION__;
+            constexpr auto begin = signature.find("T = ") + std::string_view("T = ").size();
+            constexpr auto end = signature.find_first_of(";]", begin);
+#endif
+            return signature.substr(begin, end - begin);
+        }
+
+        inline std::size_t next_type_index()
+        {
+            static std::atomic<std::size_t> next{ 0 };
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Dense process-wide index of T, assigned on first use. Containers use it to address
+        // their slot array directly instead of hashing types.
+        template<typename T>
+        std::size_t type_index()
         {
-            static_assert(false, "Constructor for class BASE_T argument type T should be std::shared_ptr.");
+            static const std::size_t index = next_type_index();
+            return index;
         }
 
-        template<class BASE_T, size_t N, class TUPLE_T, class T = typename std::tuple_element<N, TUPLE_T>::type>
-        static void construct_tuple_assign(TUPLE_T& tuple)
+        // Runtime view of a registration: the dependency edges discovered through
+        // refl::as_tuple, used to schedule work over the whole graph.
+        struct node
         {
-            if constexpr (internal::is_shared_ptr<T>::value)
+            void (*warm)();
+            // Drops the instance, by destroying it or, when abandon is set, by leaking it.
+            void (*release)(bool abandon);
+            bool (*constructed)();
+            long (*use_count)();
+            lifetime kind = lifetime::singleton;
+            bool disposable = false;
+            std::vector<node*> dependencies;
+
+            // Reported by di::report().
+            std::string_view name;
+            std::string_view key;
+            std::size_t size = 0;
+            // Written before the instance is published, read after observing constructed().
+            std::chrono::nanoseconds construction_time{ 0 };
+
+            node(void (*warm)(), void (*release)(bool), bool (*constructed)(), long (*use_count)())
+                : warm(warm), release(release), constructed(constructed), use_count(use_count)
             {
-                std::get<N>(tuple) = registry<typename T::element_type>::get();
             }
-            else
+        };
+
+        // True once the attempt behind done has finished by throwing.
+        inline bool threw(const std::shared_future<void>& done)
+        {
+#ifndef CPP_DI_NO_EXCEPTIONS
+            if (done.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
             {
-                fail_type<BASE_T, T>();
+                try
+                {
+                    done.get();
+                }
+                catch (...)
+                {
+                    return true;
+                }
+            }
+#endif
+            return false;
+        }
+
+        // Starts the construction of every dependency of target first, each on its own task,
+        // then builds target once they are all ready. Non-singletons are not built here since
+        // each dependent makes its own instance, only their dependencies are started. A single
+        // scheduler for the whole graph keeps std::async and future state out of registry<T>.
+        // An attempt that threw is started over by the next caller, as get() would.
+        inline std::shared_future<void> warm_async(node* target)
+        {
+            static std::mutex lock;
+            static std::unordered_map<node*, std::shared_future<void>> started;
+
+            {
+                std::lock_guard guard(lock);
+                if (auto it = started.find(target); it != started.end() && !threw(it->second))
+                {
+                    return it->second;
+                }
+            }
+            if (target->constructed())
+            {
+                std::promise<void> done;
+                done.set_value();
+                return done.get_future().share();
+            }
+
+            std::vector<std::shared_future<void>> dependencies;
+            for (auto dependency : target->dependencies)
+            {
+                dependencies.push_back(warm_async(dependency));
+            }
+
+            std::lock_guard guard(lock);
+            auto& done = started[target];
+            if (!done.valid() || threw(done))
+            {
+                done = std::async(std::launch::async, [target, dependencies = std::move(dependencies)]()
+                {
+                    for (auto& dependency : dependencies)
+                    {
+                        dependency.get();
+                    }
+                    if (target->kind == lifetime::singleton)
+                    {
+                        target->warm();
+                    }
+                }).share();
             }
+            return done;
         }
 
-        template <typename BASE_T, std::size_t From, size_t... indices, typename TUPLE_T>
-        static void construct_tuple(TUPLE_T& tuple, std::index_sequence<indices...>)
+        inline std::atomic<failure_handler> on_failure{ nullptr };
+
+        // Every failure funnels through here, out of line so that no resolution path inlines
+        // the construction of an exception.
+        [[noreturn]] CPP_DI_COLD inline void raise(errc code, const char* message)
         {
-            (void)std::initializer_list<int>{(construct_tuple_assign<BASE_T, indices, TUPLE_T>(tuple), 0)...};
+#ifdef CPP_DI_NO_EXCEPTIONS
+            if (auto handler = on_failure.load(std::memory_order_acquire))
+            {
+                handler(code, message);
+            }
+            std::abort();
+#else
+            throw error(code, message);
+#endif
         }
 
+#ifdef CPP_DI_NO_EXCEPTIONS
+        // Outcome of the di::try_get in flight on this thread, if any.
+        inline thread_local errc* pending_failure = nullptr;
+
+        // Installs a failure slot for the calling thread for as long as it lives.
+        struct failure_scope
+        {
+            errc* previous;
+
+            explicit failure_scope(errc& slot) noexcept : previous(pending_failure) { pending_failure = &slot; }
+            ~failure_scope() { pending_failure = previous; }
+        };
+#endif
 
-        template <typename BASE_T, std::size_t From, std::size_t To, typename TUPLE_T>
-        static void construct_tuple(TUPLE_T& tuple)
+        // Whether the resolution in flight on this thread has failed and is unwinding. Without
+        // exceptions the factories check it to return empty instead of building on top of a
+        // dependency that could not be resolved.
+        inline bool failed() noexcept
         {
-            construct_tuple<BASE_T, From>(tuple, std::make_index_sequence<To - From>());
+#ifdef CPP_DI_NO_EXCEPTIONS
+            return pending_failure && *pending_failure != errc::none;
+#else
+            return false;
+#endif
         }
 
-        template <class T, class TUPLE_T, size_t... indices>
-        constexpr static std::shared_ptr<T> make_shared_from_tuple_impl(TUPLE_T&& tuple, std::index_sequence<indices...>)
+        // A failure a resolution can recover from. Within di::try_get without exceptions it is
+        // recorded for the caller and the failing path returns empty; otherwise as raise().
+        CPP_DI_COLD inline void fail(errc code, const char* message)
         {
-            return std::make_shared<T>(std::get<indices>(std::forward<TUPLE_T>(tuple))...);
+#ifdef CPP_DI_NO_EXCEPTIONS
+            if (pending_failure)
+            {
+                if (*pending_failure == errc::none)
+                {
+                    *pending_failure = code;
+                }
+                return;
+            }
+#endif
+            raise(code, message);
         }
 
-        template<typename T, typename TUPLE_T>
-        static std::shared_ptr<T> make_shared_from_tuple(TUPLE_T&& tuple)
+        // Stands in for a reference argument that could not be resolved. Never accessed: the
+        // constructor receiving it is skipped once internal::failed() is set.
+        template<typename T>
+        alignas(T) inline unsigned char unresolved[sizeof(T)];
+
+        inline const char* describe(errc code) noexcept
         {
-            return make_shared_from_tuple_impl<T>(tuple, std::make_index_sequence<std::tuple_size_v<std::remove_reference_t<TUPLE_T>>>{});
+            switch (code)
+            {
+            case errc::none: return "cpp_di: no error";
+            case errc::not_registered: return "cpp_di: type is not registered";
+            case errc::wrong_lifetime: return "cpp_di: resolution not supported by the registered lifetime";
+            case errc::outside_scope: return "cpp_di: scoped type resolved outside of a scope";
+            case errc::already_resolved: return "cpp_di: multi-binding extended after it was resolved";
+            case errc::type_id_collision: return "cpp_di: stable type id collision in the shared registry";
+            case errc::construction_failed: return "cpp_di: construction failed";
+            }
+            return "cpp_di: unknown error";
         }
-    public:
 
+        inline void write_escaped(std::ostream& out, std::string_view text)
+        {
+            for (auto c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out << '\\';
+                }
+                out << c;
+            }
+        }
+    }
 
-        template<typename T, typename PTR_T = std::shared_ptr<T>, typename CNSTR_T = std::function<PTR_T()>>
-        class registry
+#ifdef CPP_DI_TRACE
+    // Construction tracing, compiled in only when CPP_DI_TRACE is defined. Every factory run
+    // records one event with its wall time inclusive of and excluding the dependencies it had
+    // to build, the thread it ran on and the bytes requested through its allocator.
+    namespace trace
+    {
+        struct event
+        {
+            std::string_view name;
+            std::uint32_t thread;
+            std::chrono::nanoseconds start;
+            std::chrono::nanoseconds inclusive;
+            std::chrono::nanoseconds self;
+            std::size_t bytes;
+        };
+
+        class span
         {
-            inline static std::once_flag flag;
-            inline static PTR_T obj;
+            inline static std::mutex mutex;
+            inline static std::vector<event> events;
+            inline static const auto epoch = std::chrono::steady_clock::now();
+            inline static std::atomic<std::uint32_t> threads{ 0 };
+            inline static thread_local span* current = nullptr;
+
+            std::string_view name;
+            span* parent;
+            std::chrono::steady_clock::time_point start;
+            std::chrono::nanoseconds children{ 0 };
+            std::size_t bytes = 0;
+
+            static std::uint32_t thread()
+            {
+                thread_local const std::uint32_t id = threads.fetch_add(1, std::memory_order_relaxed);
+                return id;
+            }
         public:
-            inline static CNSTR_T constructor;
+            explicit span(std::string_view name) : name(name), parent(current), start(std::chrono::steady_clock::now())
+            {
+                current = this;
+            }
 
-            inline static PTR_T get()
+            ~span()
             {
-                std::call_once(flag, []() { obj = constructor(); });
-                return obj;
+                auto inclusive = std::chrono::steady_clock::now() - start;
+                current = parent;
+                if (parent)
+                {
+                    parent->children += inclusive;
+                }
+
+                std::lock_guard lock(mutex);
+                events.push_back({ name, thread(), start - epoch, inclusive, inclusive - children, bytes });
+            }
+
+            span(const span&) = delete;
+            span& operator=(const span&) = delete;
+
+            static void allocated(std::size_t size)
+            {
+                if (current)
+                {
+                    current->bytes += size;
+                }
+            }
+
+            static std::vector<event> snapshot()
+            {
+                std::lock_guard lock(mutex);
+                return events;
+            }
+
+            static void clear()
+            {
+                std::lock_guard lock(mutex);
+                events.clear();
             }
         };
 
-        template<typename INTERFACE_T, typename T, std::enable_if_t<(std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>) && std::is_default_constructible_v<T>, bool> = true>
-        static void add()
+        // Adds the size of every allocation to the innermost open span.
+        template<typename ALLOC_T>
+        struct counting_allocator : ALLOC_T
         {
-            type_registry::set_type<INTERFACE_T>();
+            using value_type = typename std::allocator_traits<ALLOC_T>::value_type;
+
+            template<typename U>
+            struct rebind { using other = counting_allocator<typename std::allocator_traits<ALLOC_T>::template rebind_alloc<U>>; };
+
+            counting_allocator() = default;
+
+            template<typename OTHER_T>
+            counting_allocator(const counting_allocator<OTHER_T>& other) : ALLOC_T(static_cast<const OTHER_T&>(other)) {}
 
-            if (registry<INTERFACE_T>::constructor)
+            value_type* allocate(std::size_t n)
             {
-                return;
+                span::allocated(n * sizeof(value_type));
+                return std::allocator_traits<ALLOC_T>::allocate(*this, n);
             }
+        };
+
+        inline std::vector<event> events()
+        {
+            return span::snapshot();
+        }
+
+        inline void clear()
+        {
+            span::clear();
+        }
 
-            if constexpr (std::is_same_v<T, INTERFACE_T>)
+        // Writes the recorded events in the Chrome trace event format, loadable by
+        // chrome://tracing and Perfetto.
+        inline void write_chrome_trace(std::ostream& out)
+        {
+            auto us = [](std::chrono::nanoseconds ns) { return ns.count() / 1000.0; };
+
+            out << "{\"traceEvents\":[";
+            bool first = true;
+            for (auto& e : events())
             {
-                registry<T>::constructor = []() { return std::make_shared<T>(); };
+                out << (first ? "" : ",") << "{\"name\":\"";
+                internal::write_escaped(out, e.name);
+                out << "\",\"cat\":\"cpp_di\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.thread
+                    << ",\"ts\":" << us(e.start) << ",\"dur\":" << us(e.inclusive)
+                    << ",\"args\":{\"self_us\":" << us(e.self) << ",\"bytes\":" << e.bytes << "}}";
+                first = false;
             }
-            else
+            out << "],\"displayTimeUnit\":\"ms\"}";
+        }
+    }
+
+    namespace internal
+    {
+        template<typename ALLOC_T> using factory_allocator_t = trace::counting_allocator<ALLOC_T>;
+    }
+
+#define CPP_DI_TRACE_SPAN(T) ::cpp_di::trace::span _cpp_di_span(::cpp_di::internal::type_name<T>())
+#else
+    namespace internal
+    {
+        template<typename ALLOC_T> using factory_allocator_t = ALLOC_T;
+    }
+
+#define CPP_DI_TRACE_SPAN(T) (void)0
+#endif
+
+    // Allocator keeping a per-thread free list of single-object blocks, so that
+    // high-rate transient objects are recycled without hitting global operator new.
+    // A block released on another thread joins that thread's list; each list caps at
+    // capacity blocks, beyond which blocks go back to the system, so a thread only ever
+    // freeing objects built elsewhere does not hoard memory. Cached blocks are returned
+    // to the system when the owning thread exits.
+    template<typename T>
+    class pool_allocator
+    {
+        union block
+        {
+            block* next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        // Kept trivially destructible so it stays usable during static destruction,
+        // after the drain below has run for the main thread.
+        struct free_list
+        {
+            block* head = nullptr;
+            std::size_t size = 0;
+            bool closed = false;
+        };
+
+        struct drain
+        {
+            ~drain()
             {
-                registry<INTERFACE_T>::constructor = []() { return std::static_pointer_cast<INTERFACE_T>(std::make_shared<T>()); };
+                while (list.head)
+                {
+                    auto next = list.head->next;
+                    std::allocator<block>{}.deallocate(list.head, 1);
+                    list.head = next;
+                }
+                list.size = 0;
+                list.closed = true;
             }
+        };
+
+        inline static thread_local free_list list;
+
+        static free_list& local()
+        {
+            thread_local drain d;
+            (void)d;
+            return list;
         }
+    public:
+        using value_type = T;
 
-        template<typename INTERFACE_T, typename T, std::enable_if_t<(std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>) && !std::is_default_constructible_v<T>, bool> = true>
-        static void add()
+        static constexpr std::size_t capacity = 256;
+
+        pool_allocator() noexcept = default;
+
+        template<typename U>
+        pool_allocator(const pool_allocator<U>&) noexcept {}
+
+        T* allocate(std::size_t n)
         {
-            type_registry::set_type<INTERFACE_T>();
+            if (n != 1)
+            {
+                return std::allocator<T>{}.allocate(n);
+            }
 
-            using ctr_type = refl::as_tuple<T>;
+            auto& pool = local();
+            if (auto b = pool.head)
+            {
+                pool.head = b->next;
+                pool.size--;
+                return reinterpret_cast<T*>(b->storage);
+            }
+            return reinterpret_cast<T*>(std::allocator<block>{}.allocate(1)->storage);
+        }
 
-            if (registry<INTERFACE_T>::constructor)
+        void deallocate(T* ptr, std::size_t n) noexcept
+        {
+            if (n != 1)
             {
+                std::allocator<T>{}.deallocate(ptr, n);
                 return;
             }
 
-            if constexpr (std::is_same_v<T, INTERFACE_T>)
+            auto b = reinterpret_cast<block*>(ptr);
+            auto& pool = local();
+            if (pool.closed || pool.size >= capacity)
             {
-                registry<INTERFACE_T>::constructor = []()
-                {
-                    ctr_type args;
-                    construct_tuple<T, 0, std::tuple_size_v<ctr_type>>(args);
-                    return make_shared_from_tuple<INTERFACE_T>(args);
-                };
+                std::allocator<block>{}.deallocate(b, 1);
+                return;
             }
-            else
+            b->next = pool.head;
+            pool.head = b;
+            pool.size++;
+        }
+
+        template<typename U>
+        bool operator==(const pool_allocator<U>&) const noexcept { return true; }
+
+        template<typename U>
+        bool operator!=(const pool_allocator<U>&) const noexcept { return false; }
+    };
+
+    // Constructor parameter deferring the resolution of T until it is first dereferenced, so a
+    // service does not pull in dependencies it only touches on rare paths. Resolution happens
+    // in the container or scope the owner was built in. After the first access every
+    // dereference is a single acquire load.
+    template<typename T>
+    class lazy
+    {
+        using resolver_t = std::shared_ptr<T> (*)(void* owner, void* scope);
+
+        resolver_t resolver = nullptr;
+        void* owner = nullptr;
+        void* scope = nullptr;
+
+        mutable std::atomic<T*> instance{ nullptr };
+        mutable std::shared_ptr<T> obj;
+        mutable std::mutex mutex;
+
+        lazy(resolver_t resolver, void* owner, void* scope) : resolver(resolver), owner(owner), scope(scope) {}
+
+        T* load() const
+        {
+            if (auto ptr = instance.load(std::memory_order_acquire))
+            {
+                return ptr;
+            }
+
+            std::lock_guard lock(mutex);
+            if (!instance.load(std::memory_order_relaxed))
+            {
+                obj = resolver(owner, scope);
+                instance.store(obj.get(), std::memory_order_release);
+            }
+            return instance.load(std::memory_order_relaxed);
+        }
+
+        friend class di;
+    public:
+        using element_type = T;
+
+        lazy() = default;
+
+        // Moving is only meant for handing the proxy into the constructor of its owner.
+        lazy(lazy&& other) noexcept
+            : resolver(other.resolver)
+            , owner(other.owner)
+            , scope(other.scope)
+            , instance(other.instance.load(std::memory_order_relaxed))
+            , obj(std::move(other.obj))
+        {
+        }
+
+        lazy& operator=(lazy&& other) noexcept
+        {
+            resolver = other.resolver;
+            owner = other.owner;
+            scope = other.scope;
+            instance.store(other.instance.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            obj = std::move(other.obj);
+            return *this;
+        }
+
+        T* get() const { return load(); }
+        T* operator->() const { return load(); }
+        T& operator*() const { return *load(); }
+
+        std::shared_ptr<T> shared() const
+        {
+            load();
+            return obj;
+        }
+
+        bool resolved() const { return instance.load(std::memory_order_acquire) != nullptr; }
+    };
+
+    // Constructor parameter receiving every implementation registered for INTERFACE_T through
+    // di::add_all, in registration order. The instances sit in one contiguous array built on
+    // first resolution and shared by all holders, so iterating it touches no map or list nodes.
+    // Multi-bindings always resolve from the global registry.
+    template<typename INTERFACE_T>
+    class all
+    {
+        std::shared_ptr<const std::shared_ptr<INTERFACE_T>[]> items;
+        std::size_t count = 0;
+
+        all(std::shared_ptr<const std::shared_ptr<INTERFACE_T>[]> items, std::size_t count) : items(std::move(items)), count(count) {}
+
+        friend class di;
+    public:
+        using element_type = INTERFACE_T;
+        using value_type = std::shared_ptr<INTERFACE_T>;
+        using const_iterator = const value_type*;
+
+        all() = default;
+
+        const_iterator begin() const noexcept { return items.get(); }
+        const_iterator end() const noexcept { return items.get() + count; }
+
+        std::size_t size() const noexcept { return count; }
+        bool empty() const noexcept { return count == 0; }
+
+        const value_type& operator[](std::size_t index) const noexcept { return items[index]; }
+    };
+
+    // Instance on loan from the pool of T, given back when the handle is destroyed. Obtained
+    // from di::acquire or injected as a constructor parameter.
+    template<typename T>
+    class pooled
+    {
+        T* ptr = nullptr;
+        void (*recycle)(T*) = nullptr;
+
+        pooled(T* ptr, void (*recycle)(T*)) : ptr(ptr), recycle(recycle) {}
+
+        friend class di;
+    public:
+        using element_type = T;
+
+        pooled() = default;
+
+        pooled(pooled&& other) noexcept : ptr(std::exchange(other.ptr, nullptr)), recycle(other.recycle) {}
+
+        pooled& operator=(pooled&& other) noexcept
+        {
+            if (this != &other)
             {
-                registry<INTERFACE_T>::constructor = []()
+                if (ptr)
                 {
-                    ctr_type args;
-                    construct_tuple<T, 0, std::tuple_size_v<ctr_type>>(args);
-                    return std::static_pointer_cast<INTERFACE_T>(make_shared_from_tuple<T>(args));
-                };
+                    recycle(ptr);
+                }
+                ptr = std::exchange(other.ptr, nullptr);
+                recycle = other.recycle;
             }
+            return *this;
         }
 
-        template<typename T>
-        static void add() { type_registry::set_type<T>(); add<T, T>(); }
+        ~pooled()
+        {
+            if (ptr)
+            {
+                recycle(ptr);
+            }
+        }
 
-        template<typename T>
-        static std::shared_ptr<T> get()
+        T* get() const noexcept { return ptr; }
+        T* operator->() const noexcept { return ptr; }
+        T& operator*() const noexcept { return *ptr; }
+
+        explicit operator bool() const noexcept { return ptr != nullptr; }
+    };
+
+    namespace internal
+    {
+        struct local_block
         {
-            type_registry::check_type<T>();
-            return registry<T>::get();
+            std::size_t references = 1;
+            void (*destroy)(local_block*) noexcept = nullptr;
+        };
+
+        // Control block and object of a local_ptr in one allocation, as std::allocate_shared does.
+        template<typename T, typename ALLOC_T>
+        struct local_inplace : local_block
+        {
+            using allocator_t = typename std::allocator_traits<ALLOC_T>::template rebind_alloc<local_inplace>;
+
+            allocator_t allocator;
+            alignas(T) unsigned char storage[sizeof(T)];
+
+            explicit local_inplace(const allocator_t& allocator) : allocator(allocator)
+            {
+                destroy = &destroy_block;
+            }
+
+            T* object() noexcept { return reinterpret_cast<T*>(storage); }
+
+            static void destroy_block(local_block* block) noexcept
+            {
+                auto self = static_cast<local_inplace*>(block);
+                auto allocator = std::move(self->allocator);
+                self->object()->~T();
+                self->~local_inplace();
+                std::allocator_traits<allocator_t>::deallocate(allocator, self, 1);
+            }
+
+            template<typename... ARGS>
+            static local_ptr<T> make(const ALLOC_T& source, ARGS&&... args)
+            {
+                allocator_t allocator(source);
+                auto self = std::allocator_traits<allocator_t>::allocate(allocator, 1);
+                ::new (static_cast<void*>(self)) local_inplace(allocator);
+#ifndef CPP_DI_NO_EXCEPTIONS
+                try
+                {
+                    ::new (static_cast<void*>(self->storage)) T(std::forward<ARGS>(args)...);
+                }
+                catch (...)
+                {
+                    auto a = std::move(self->allocator);
+                    self->~local_inplace();
+                    std::allocator_traits<allocator_t>::deallocate(a, self, 1);
+                    throw;
+                }
+#else
+                ::new (static_cast<void*>(self->storage)) T(std::forward<ARGS>(args)...);
+#endif
+                return local_ptr<T>(self, self->object());
+            }
+        };
+    }
+
+    // Shared pointer with a non-atomic reference count, for graphs confined to one thread such
+    // as thread-per-core shards.
+    template<typename T>
+    class local_ptr
+    {
+        internal::local_block* block = nullptr;
+        T* ptr = nullptr;
+
+        local_ptr(internal::local_block* block, T* ptr) noexcept : block(block), ptr(ptr) {}
+
+        template<typename> friend class local_ptr;
+        template<typename, typename> friend struct internal::local_inplace;
+    public:
+        using element_type = T;
+
+        local_ptr() noexcept = default;
+
+        local_ptr(const local_ptr& other) noexcept : block(other.block), ptr(other.ptr)
+        {
+            if (block)
+            {
+                block->references++;
+            }
+        }
+
+        local_ptr(local_ptr&& other) noexcept : block(std::exchange(other.block, nullptr)), ptr(std::exchange(other.ptr, nullptr)) {}
+
+        template<typename U, std::enable_if_t<std::is_convertible_v<U*, T*>, bool> = true>
+        local_ptr(local_ptr<U> other) noexcept : block(std::exchange(other.block, nullptr)), ptr(std::exchange(other.ptr, nullptr)) {}
+
+        ~local_ptr()
+        {
+            reset();
+        }
+
+        local_ptr& operator=(local_ptr other) noexcept
+        {
+            std::swap(block, other.block);
+            std::swap(ptr, other.ptr);
+            return *this;
+        }
+
+        void reset() noexcept
+        {
+            if (block && --block->references == 0)
+            {
+                block->destroy(block);
+            }
+            block = nullptr;
+            ptr = nullptr;
+        }
+
+        T* get() const noexcept { return ptr; }
+        T* operator->() const noexcept { return ptr; }
+        T& operator*() const noexcept { return *ptr; }
+        explicit operator bool() const noexcept { return ptr != nullptr; }
+        std::size_t use_count() const noexcept { return block ? block->references : 0; }
+
+        template<typename U>
+        static local_ptr static_pointer_cast(local_ptr<U>&& other) noexcept
+        {
+            return local_ptr(std::exchange(other.block, nullptr), static_cast<T*>(std::exchange(other.ptr, nullptr)));
+        }
+    };
+
+    // Base providing the reference count expected by intrusive_ptr through the
+    // intrusive_add_ref / intrusive_release customization points, found by ADL.
+    class intrusive_base
+    {
+        mutable std::atomic<std::size_t> references{ 0 };
+
+        friend void intrusive_add_ref(const intrusive_base* ptr) noexcept
+        {
+            ptr->references.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        friend void intrusive_release(const intrusive_base* ptr) noexcept
+        {
+            if (ptr->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete ptr;
+            }
+        }
+    protected:
+        intrusive_base() = default;
+        intrusive_base(const intrusive_base&) noexcept {}
+        intrusive_base& operator=(const intrusive_base&) noexcept { return *this; }
+        virtual ~intrusive_base() = default;
+    };
+
+    // Pointer to an object carrying its own reference count: one word wide and no separate
+    // control block.
+    template<typename T>
+    class intrusive_ptr
+    {
+        T* ptr = nullptr;
+
+        template<typename> friend class intrusive_ptr;
+    public:
+        using element_type = T;
+
+        intrusive_ptr() noexcept = default;
+
+        explicit intrusive_ptr(T* ptr) noexcept : ptr(ptr)
+        {
+            if (ptr)
+            {
+                intrusive_add_ref(ptr);
+            }
+        }
+
+        intrusive_ptr(const intrusive_ptr& other) noexcept : intrusive_ptr(other.ptr) {}
+        intrusive_ptr(intrusive_ptr&& other) noexcept : ptr(std::exchange(other.ptr, nullptr)) {}
+
+        template<typename U, std::enable_if_t<std::is_convertible_v<U*, T*>, bool> = true>
+        intrusive_ptr(intrusive_ptr<U> other) noexcept : ptr(std::exchange(other.ptr, nullptr)) {}
+
+        ~intrusive_ptr()
+        {
+            reset();
+        }
+
+        intrusive_ptr& operator=(intrusive_ptr other) noexcept
+        {
+            std::swap(ptr, other.ptr);
+            return *this;
+        }
+
+        void reset() noexcept
+        {
+            if (ptr)
+            {
+                intrusive_release(std::exchange(ptr, nullptr));
+            }
+        }
+
+        T* get() const noexcept { return ptr; }
+        T* operator->() const noexcept { return ptr; }
+        T& operator*() const noexcept { return *ptr; }
+        explicit operator bool() const noexcept { return ptr != nullptr; }
+
+        template<typename U>
+        static intrusive_ptr static_pointer_cast(intrusive_ptr<U>&& other) noexcept
+        {
+            intrusive_ptr result;
+            result.ptr = static_cast<T*>(std::exchange(other.ptr, nullptr));
+            return result;
+        }
+    };
+
+    // Marks T as safe to abandon at shutdown: nothing the process relies on happens in its
+    // destructor, so di::shutdown(shutdown_mode::fast_exit) leaks it instead of destroying it.
+    // Trivially destructible types qualify by default; declare `static constexpr bool
+    // trivially_disposable = ...;` in T, or specialize this trait, to decide otherwise.
+    template<typename T, typename = void>
+    struct trivially_disposable : std::is_trivially_destructible<T> {};
+
+    template<typename T>
+    struct trivially_disposable<T, std::void_t<decltype(T::trivially_disposable)>> : std::bool_constant<T::trivially_disposable> {};
+
+    // Opts T into di::replace and di::rebuild. Resolving a hot-swappable singleton additionally
+    // marks a per-thread read section, so it stays wait-free while being replaced; other types
+    // keep the plain read path. Declare `static constexpr bool hot_swappable = true;` in T or
+    // specialize this trait.
+    template<typename T, typename = void>
+    struct hot_swappable : std::false_type {};
+
+    template<typename T>
+    struct hot_swappable<T, std::void_t<decltype(T::hot_swappable)>> : std::bool_constant<T::hot_swappable> {};
+
+    enum class shutdown_mode
+    {
+        // Destroy every singleton.
+        destroy,
+        // Leak singletons marked trivially_disposable, destroy the others.
+        fast_exit
+    };
+
+    // Bounds of the pool behind a pooled registration.
+    struct pool_options
+    {
+        // Idle instances kept for reuse. Instances given back while the pool is full are destroyed.
+        std::size_t capacity = 64;
+        // Instances built ahead of the first di::acquire.
+        std::size_t prefill = 0;
+    };
+
+    // One registration as seen by di::report().
+    struct service_info
+    {
+        std::string_view name;
+        // Empty unless registered under a key.
+        std::string_view key;
+        lifetime kind;
+        bool constructed;
+        // sizeof the implementation, not counting memory it owns.
+        std::size_t size;
+        // Owners of the registry's instance, including the registry itself.
+        long use_count;
+        std::chrono::nanoseconds construction_time;
+        // Positions of the dependencies in the report.
+        std::vector<std::size_t> dependencies;
+    };
+
+    // Ownership policies. A policy names the storage a registry keeps, the pointer handed out by
+    // di::get and injected into constructors, and how instances are made and upcast.
+
+    // std::shared_ptr with atomic reference counting, the default.
+    struct shared_ownership
+    {
+        template<typename T> using storage = std::shared_ptr<T>;
+        template<typename T> using pointer = std::shared_ptr<T>;
+
+        static constexpr bool allows_transient = true;
+
+        template<typename T, typename ALLOC_T, typename... ARGS>
+        static storage<T> make(ARGS&&... args) { return std::allocate_shared<T>(ALLOC_T{}, std::forward<ARGS>(args)...); }
+
+        template<typename T, typename U>
+        static storage<T> cast(storage<U>&& ptr) { return std::static_pointer_cast<T>(std::move(ptr)); }
+
+        template<typename T>
+        static pointer<T> share(const storage<T>& ptr) { return ptr; }
+
+        template<typename T>
+        static pointer<T> share(storage<T>&& ptr) { return std::move(ptr); }
+
+        template<typename T>
+        static T* raw(const storage<T>& ptr) { return ptr.get(); }
+    };
+
+    // local_ptr with a non-atomic reference count. Instances must stay on one thread, so they
+    // belong in a di::container used by that thread rather than in the global registry, which
+    // any thread may resolve from.
+    struct local_ownership
+    {
+        template<typename T> using storage = local_ptr<T>;
+        template<typename T> using pointer = local_ptr<T>;
+
+        static constexpr bool allows_transient = true;
+
+        template<typename T, typename ALLOC_T, typename... ARGS>
+        static storage<T> make(ARGS&&... args) { return internal::local_inplace<T, ALLOC_T>::make(ALLOC_T{}, std::forward<ARGS>(args)...); }
+
+        template<typename T, typename U>
+        static storage<T> cast(storage<U>&& ptr) { return local_ptr<T>::static_pointer_cast(std::move(ptr)); }
+
+        template<typename T>
+        static pointer<T> share(const storage<T>& ptr) { return ptr; }
+
+        template<typename T>
+        static pointer<T> share(storage<T>&& ptr) { return std::move(ptr); }
+
+        template<typename T>
+        static T* raw(const storage<T>& ptr) { return ptr.get(); }
+    };
+
+    // intrusive_ptr to types deriving from intrusive_base. Objects are created with plain new
+    // since intrusive_release deletes them, so registered allocators are not used.
+    struct intrusive_ownership
+    {
+        template<typename T> using storage = intrusive_ptr<T>;
+        template<typename T> using pointer = intrusive_ptr<T>;
+
+        static constexpr bool allows_transient = true;
+
+        template<typename T, typename ALLOC_T, typename... ARGS>
+        static storage<T> make(ARGS&&... args) { return intrusive_ptr<T>(new T(std::forward<ARGS>(args)...)); }
+
+        template<typename T, typename U>
+        static storage<T> cast(storage<U>&& ptr) { return intrusive_ptr<T>::static_pointer_cast(std::move(ptr)); }
+
+        template<typename T>
+        static pointer<T> share(const storage<T>& ptr) { return ptr; }
+
+        template<typename T>
+        static pointer<T> share(storage<T>&& ptr) { return std::move(ptr); }
+
+        template<typename T>
+        static T* raw(const storage<T>& ptr) { return ptr.get(); }
+    };
+
+    // Plain owning storage: the registry holds a std::unique_ptr and hands out raw pointers,
+    // which dependents receive as T* or T&. No reference counting at all; only singletons.
+    struct unique_ownership
+    {
+        template<typename T> using storage = std::unique_ptr<T>;
+        template<typename T> using pointer = T*;
+
+        static constexpr bool allows_transient = false;
+
+        template<typename T, typename ALLOC_T, typename... ARGS>
+        static storage<T> make(ARGS&&... args) { return std::make_unique<T>(std::forward<ARGS>(args)...); }
+
+        template<typename T, typename U>
+        static storage<T> cast(storage<U>&& ptr) { return storage<T>(ptr.release()); }
+
+        template<typename T>
+        static pointer<T> share(const storage<T>& ptr) { return ptr.get(); }
+
+        template<typename T>
+        static T* raw(const storage<T>& ptr) { return ptr.get(); }
+    };
+
+    // Ownership policy of registry<T>. Declare `using pointer_policy = ...;` in T, or specialize
+    // this trait, to choose another one; interfaces decide for all of their implementations.
+    template<typename T, typename = void>
+    struct pointer_policy
+    {
+        using type = shared_ownership;
+    };
+
+    template<typename T>
+    struct pointer_policy<T, std::void_t<typename T::pointer_policy>>
+    {
+        using type = typename T::pointer_policy;
+    };
+
+    template<typename T>
+    using pointer_policy_t = typename pointer_policy<T>::type;
+
+    template<typename T>
+    using storage_t = typename pointer_policy_t<T>::template storage<T>;
+
+    template<typename T>
+    using pointer_t = typename pointer_policy_t<T>::template pointer<T>;
+
+    // Compile-time string usable as a template argument, e.g. di::add<IPool, PgPool, "replica">().
+    template<std::size_t N>
+    struct fixed_string
+    {
+        char value[N]{};
+
+        constexpr fixed_string(const char (&text)[N])
+        {
+            for (std::size_t i = 0; i < N; i++)
+            {
+                value[i] = text[i];
+            }
+        }
+
+        constexpr std::string_view view() const { return { value, N - 1 }; }
+    };
+
+    // Constructor parameter wired from the registration of T under KEY. Keyed registrations
+    // always resolve from the global registry.
+    template<typename T, fixed_string KEY>
+    class keyed
+    {
+        pointer_t<T> ptr;
+    public:
+        using element_type = T;
+        static constexpr std::string_view key = KEY.view();
+
+        keyed() = default;
+        explicit keyed(pointer_t<T> ptr) : ptr(std::move(ptr)) {}
+
+        T* get() const noexcept
+        {
+            if constexpr (std::is_pointer_v<pointer_t<T>>)
+            {
+                return ptr;
+            }
+            else
+            {
+                return ptr.get();
+            }
+        }
+
+        T* operator->() const noexcept { return get(); }
+        T& operator*() const noexcept { return *get(); }
+
+        const pointer_t<T>& pointer() const& noexcept { return ptr; }
+        pointer_t<T> pointer() && noexcept { return std::move(ptr); }
+    };
+
+    // Constructor parameter building T on demand from runtime arguments ARGS, which fill the
+    // leading parameters of its constructor, while the remaining ones are wired as usual, e.g.
+    // factory<Connection, int> for Connection(int fd, std::shared_ptr<ILog> log). ARGS are
+    // forwarded as declared, so factory<T, std::string&&> moves its argument through. T does not
+    // need to be registered and its constructor parameters come from constructor_args.
+    template<typename T, typename... ARGS>
+    class factory
+    {
+        using build_t = storage_t<T> (*)(ARGS&&...);
+
+        build_t build = nullptr;
+
+        explicit factory(build_t build) : build(build) {}
+
+        friend class di;
+    public:
+        using element_type = T;
+
+        factory() = default;
+
+        storage_t<T> operator()(ARGS... args) const
+        {
+            return build(std::forward<ARGS>(args)...);
+        }
+    };
+
+    // Outcome of di::try_get: the resolved pointer, or the reason it could not be resolved.
+    // Like std::expected, * and -> give the pointer itself, e.g. (*result)->method().
+    template<typename T>
+    class result
+    {
+        T content{};
+        errc reason = errc::none;
+    public:
+        result(T content) : content(std::move(content)) {}
+        result(errc reason) noexcept : reason(reason) {}
+
+        explicit operator bool() const noexcept { return reason == errc::none; }
+        errc error() const noexcept { return reason; }
+
+        T& value() &
+        {
+            if (reason != errc::none)
+            {
+                internal::raise(reason, internal::describe(reason));
+            }
+            return content;
+        }
+
+        T value() &&
+        {
+            return std::move(value());
+        }
+
+        const T& operator*() const noexcept { return content; }
+        const T* operator->() const noexcept { return &content; }
+    };
+
+    namespace internal
+    {
+        // Second argument of di::registry for keyed registrations, so every key of T gets its
+        // own instantiation and a keyed lookup costs the same as an unkeyed one.
+        template<fixed_string KEY> struct key_tag
+        {
+            static constexpr std::string_view value = KEY.view();
+        };
+
+        template<typename T> struct is_factory : std::false_type {};
+        template<typename T, typename... ARGS> struct is_factory<factory<T, ARGS...>> : std::true_type {};
+
+        template<typename T> struct is_keyed : std::false_type {};
+        template<typename T, fixed_string KEY> struct is_keyed<keyed<T, KEY>> : std::true_type
+        {
+            using key = key_tag<KEY>;
+        };
+    }
+
+    namespace internal
+    {
+        // Bump allocator backing singleton storage once di::use_singleton_arena has been called.
+        // Singletons are placed back to back in construction order, which is dependency order,
+        // so services calling each other share cache lines and pages. The memory is deliberately
+        // never released, singletons live until static destruction anyway.
+        class singleton_arena
+        {
+            inline static std::atomic<bool> claimed{ false };
+            inline static std::atomic<std::uintptr_t> cursor{ 0 };
+            inline static std::atomic<std::uintptr_t> begin{ 0 };
+            inline static std::atomic<std::uintptr_t> end{ 0 };
+        public:
+            static bool reserve(std::size_t capacity, bool huge_pages)
+            {
+                // Only the first successful reservation takes effect. A racing call loses the
+                // claim instead of mapping memory of its own; a failed one gives it back.
+                if (claimed.exchange(true, std::memory_order_acq_rel))
+                {
+                    return false;
+                }
+
+                void* memory = nullptr;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+                if (huge_pages)
+                {
+                    // Over-map by one huge page so the arena can start on a huge page boundary.
+                    constexpr std::size_t huge_page = std::size_t{ 2 } << 20;
+                    capacity = (capacity + huge_page - 1) & ~(huge_page - 1);
+
+                    auto mapped = ::mmap(nullptr, capacity + huge_page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (mapped != MAP_FAILED)
+                    {
+                        auto aligned = (reinterpret_cast<std::uintptr_t>(mapped) + huge_page - 1) & ~(huge_page - 1);
+                        memory = reinterpret_cast<void*>(aligned);
+                        ::madvise(memory, capacity, MADV_HUGEPAGE);
+                    }
+                }
+#else
+                (void)huge_pages;
+#endif
+                if (!memory)
+                {
+                    memory = ::operator new(capacity, std::align_val_t{ 64 }, std::nothrow);
+                }
+                if (!memory)
+                {
+                    claimed.store(false, std::memory_order_release);
+                    return false;
+                }
+
+                auto first = reinterpret_cast<std::uintptr_t>(memory);
+                begin.store(first, std::memory_order_relaxed);
+                end.store(first + capacity, std::memory_order_relaxed);
+                cursor.store(first, std::memory_order_release);
+                return true;
+            }
+
+            static void* allocate(std::size_t size, std::size_t alignment) noexcept
+            {
+                auto current = cursor.load(std::memory_order_acquire);
+                std::uintptr_t aligned;
+                do
+                {
+                    if (!current)
+                    {
+                        return nullptr;
+                    }
+
+                    aligned = (current + alignment - 1) & ~(alignment - 1);
+                    if (aligned + size > end.load(std::memory_order_relaxed))
+                    {
+                        return nullptr;
+                    }
+                } while (!cursor.compare_exchange_weak(current, aligned + size, std::memory_order_acq_rel, std::memory_order_acquire));
+
+                return reinterpret_cast<void*>(aligned);
+            }
+
+            static bool owns(const void* ptr) noexcept
+            {
+                auto address = reinterpret_cast<std::uintptr_t>(ptr);
+                return address >= begin.load(std::memory_order_acquire) && address < end.load(std::memory_order_acquire);
+            }
+        };
+
+        // Default allocator of singleton factories: takes from the singleton arena when one is
+        // reserved and has room left, from the global heap otherwise.
+        template<typename T>
+        struct singleton_allocator
+        {
+            using value_type = T;
+
+            singleton_allocator() noexcept = default;
+
+            template<typename U>
+            singleton_allocator(const singleton_allocator<U>&) noexcept {}
+
+            T* allocate(std::size_t n)
+            {
+                if (auto ptr = singleton_arena::allocate(n * sizeof(T), alignof(T)))
+                {
+                    return static_cast<T*>(ptr);
+                }
+                return std::allocator<T>{}.allocate(n);
+            }
+
+            void deallocate(T* ptr, std::size_t n) noexcept
+            {
+                if (!singleton_arena::owns(ptr))
+                {
+                    std::allocator<T>{}.deallocate(ptr, n);
+                }
+            }
+
+            template<typename U>
+            bool operator==(const singleton_allocator<U>&) const noexcept { return true; }
+
+            template<typename U>
+            bool operator!=(const singleton_allocator<U>&) const noexcept { return false; }
+        };
+
+        // Storage of one type padded to a cache line of its own, for per-type statics read on
+        // every resolution, which would otherwise share lines with the statics of other types.
+        template<typename T>
+        struct alignas(64) cache_line : T
+        {
+            using T::T;
+        };
+
+        // Once-initialisation flag. Unlike std::once_flag, waiters park on the state word with
+        // atomic wait instead of a lock, and after publication a call costs one acquire load.
+        class once_flag
+        {
+            static constexpr std::uint32_t idle = 0, running = 1, contended = 2, done = 3;
+
+            std::atomic<std::uint32_t> state{ idle };
+
+            // Hands the flag back when the function did not complete, e.g. it threw or reported
+            // a failure through internal::fail, so that the next caller runs it again.
+            struct attempt
+            {
+                once_flag& flag;
+                bool completed = false;
+
+                ~attempt()
+                {
+                    if (flag.state.exchange(completed ? done : idle, std::memory_order_acq_rel) == contended)
+                    {
+                        flag.state.notify_all();
+                    }
+                }
+            };
+
+            template<typename... ARGS>
+            friend void call_once(once_flag& flag, void (*function)(ARGS...), ARGS... args);
+        public:
+            once_flag() = default;
+            once_flag(const once_flag&) = delete;
+            once_flag& operator=(const once_flag&) = delete;
+        };
+
+        // Runs function once per flag; concurrent callers return once it has completed. Takes
+        // plain functions only: instantiated with a lambda, a template gets a name that is the
+        // same in every module while its body touches the statics of one module, and templates
+        // keep default visibility under -fvisibility=hidden, so the dynamic linker may then run
+        // one module's body on behalf of all of them.
+        template<typename... ARGS>
+        void call_once(once_flag& flag, void (*function)(ARGS...), ARGS... args)
+        {
+            auto state = flag.state.load(std::memory_order_acquire);
+            while (state != once_flag::done)
+            {
+                if (failed())
+                {
+                    return;
+                }
+                if (state == once_flag::idle)
+                {
+                    if (flag.state.compare_exchange_weak(state, once_flag::running, std::memory_order_acquire))
+                    {
+                        once_flag::attempt guard{ flag };
+                        function(args...);
+                        guard.completed = !failed();
+                        return;
+                    }
+                    continue;
+                }
+                if (state == once_flag::running && !flag.state.compare_exchange_weak(state, once_flag::contended, std::memory_order_acquire))
+                {
+                    continue;
+                }
+                flag.state.wait(once_flag::contended, std::memory_order_acquire);
+                state = flag.state.load(std::memory_order_acquire);
+            }
+        }
+
+        // NUMA node the calling thread runs on, looked up once per thread. Threads migrating
+        // across nodes keep their first answer, so pin workers that should stay local.
+        inline std::size_t numa_node()
+        {
+#if defined(__linux__) && defined(SYS_getcpu)
+            thread_local const std::size_t node = []()
+            {
+                unsigned cpu = 0, node = 0;
+                return syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 ? static_cast<std::size_t>(node) : std::size_t{ 0 };
+            }();
+            return node % CPP_DI_MAX_NUMA_NODES;
+#else
+            return 0;
+#endif
+        }
+
+#ifdef CPP_DI_SHARED_REGISTRY
+        // FNV-1a of the type name, identical in every module built by the same compiler.
+        constexpr std::uint64_t stable_type_id(std::string_view name)
+        {
+            std::uint64_t hash = 14695981039346656037ull;
+            for (auto c : name)
+            {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        // Entry of the process-wide table for one registration. The factory is the first one
+        // published by any module, and so is the instance; modules contributing either must stay
+        // loaded for as long as it is used.
+        struct shared_slot
+        {
+            std::string_view name;
+            internal::once_flag flag;
+            std::atomic<std::shared_ptr<void> (*)()> factory{ nullptr };
+            std::shared_ptr<void> obj;
+        };
+
+        class shared_table
+        {
+            std::mutex mutex;
+            std::unordered_map<std::uint64_t, std::unique_ptr<shared_slot>> slots;
+        public:
+            // Called once per registration and module, which then keeps the slot.
+            shared_slot& slot(std::string_view name)
+            {
+                std::lock_guard lock(mutex);
+                auto& entry = slots[stable_type_id(name)];
+                if (!entry)
+                {
+                    entry = std::make_unique<shared_slot>();
+                    entry->name = name;
+                }
+                else if (entry->name != name)
+                {
+                    internal::raise(errc::type_id_collision, "cpp_di: stable type id collision in the shared registry");
+                }
+                return *entry;
+            }
+        };
+
+        CPP_DI_REGISTRY_API shared_table& shared_registry();
+
+#ifdef CPP_DI_EXPORT_REGISTRY
+        CPP_DI_REGISTRY_API shared_table& shared_registry()
+        {
+            static shared_table table;
+            return table;
+        }
+#endif
+#endif
+
+        // Read side of the grace period behind di::replace. Every thread owns a record whose
+        // sequence is odd while it copies a hot_swappable singleton; a writer that unpublished a
+        // cell waits for each odd sequence it sees to move on before destroying the cell. Readers
+        // never wait and only touch their own cache line. Records are reused, never freed.
+        class swap_readers
+        {
+            struct alignas(64) record
+            {
+                std::atomic<std::uint64_t> sequence{ 0 };
+                std::atomic<bool> in_use{ true };
+                record* next = nullptr;
+            };
+
+            struct handle
+            {
+                record* owned;
+
+                ~handle() { owned->in_use.store(false, std::memory_order_release); }
+            };
+
+            inline static std::atomic<record*> head{ nullptr };
+
+            static record* acquire()
+            {
+                for (auto r = head.load(std::memory_order_acquire); r; r = r->next)
+                {
+                    bool free = false;
+                    if (r->in_use.compare_exchange_strong(free, true, std::memory_order_acq_rel))
+                    {
+                        return r;
+                    }
+                }
+
+                auto r = new record();
+                r->next = head.load(std::memory_order_relaxed);
+                while (!head.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed))
+                {
+                }
+                return r;
+            }
+
+            // Constant-initialized, so the read path tests a pointer rather than a guard.
+            inline static thread_local record* mine = nullptr;
+
+            static record& local()
+            {
+                if (!mine)
+                {
+                    thread_local handle h{ acquire() };
+                    mine = h.owned;
+                }
+                return *mine;
+            }
+
+            // Readers and the writer pair their fences Dekker-style: the store of an odd sequence
+            // against the load of the cell, and the exchange of the cell against the loads of the
+            // sequences. Where membarrier() is available the writer makes every running thread
+            // execute the barrier, and readers only keep the compiler from reordering.
+            inline static std::atomic<bool> asymmetric{ false };
+
+            static void light_fence() noexcept
+            {
+                if (asymmetric.load(std::memory_order_relaxed))
+                {
+                    std::atomic_signal_fence(std::memory_order_seq_cst);
+                }
+                else
+                {
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                }
+            }
+
+            static void heavy_fence() noexcept
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+#if defined(CPP_DI_MEMBARRIER)
+                // Registered by the first writer. Readers switch to the light fence only after
+                // that, while every writer from then on issues the barrier.
+                static const bool registered = []()
+                {
+                    bool ok = syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0
+                        && syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0) == 0;
+                    if (ok)
+                    {
+                        asymmetric.store(true, std::memory_order_release);
+                    }
+                    return ok;
+                }();
+                if (registered)
+                {
+                    syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+                }
+#endif
+            }
+        public:
+            template<typename CELL_T, typename F>
+            static auto read(const std::atomic<CELL_T*>& cell, F&& copy)
+            {
+                auto& r = local();
+                // Only the owning thread writes its sequence, so no read-modify-write is needed.
+                auto sequence = r.sequence.load(std::memory_order_relaxed);
+                r.sequence.store(sequence + 1, std::memory_order_relaxed);
+                light_fence();
+                auto result = copy(*cell.load(std::memory_order_acquire));
+                r.sequence.store(sequence + 2, std::memory_order_release);
+                return result;
+            }
+
+            // Returns once no reader can still be copying from a cell unpublished before the call.
+            static void synchronize()
+            {
+                heavy_fence();
+                for (auto r = head.load(std::memory_order_acquire); r; r = r->next)
+                {
+                    auto sequence = r->sequence.load(std::memory_order_acquire);
+                    if (sequence & 1)
+                    {
+                        while (r->sequence.load(std::memory_order_acquire) == sequence)
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+            }
+        };
+    }
+
+    class di
+    {
+        template<typename CLASS_T, typename ARGUMENT_T>
+        static void fail_type()
+        {
+            static_assert(sizeof(ARGUMENT_T*) == 0, "Constructor for class CLASS_T argument type ARGUMENT_T should be std::shared_ptr, "
+                "cpp_di::lazy, cpp_di::all, cpp_di::keyed, cpp_di::pooled, cpp_di::factory, a pointer, std::unique_ptr or, through constructor_args, a reference.");
+        }
+
+        // Each argument is produced as a prvalue and moved along the whole path into the
+        // constructor, so the only refcount operation per dependency is the one made by get().
+        template<class BASE_T, class T>
+        static T construct_argument()
+        {
+            if constexpr (is_inner_argument<BASE_T, T>::value)
+            {
+                // The decorated instance, built by whatever was registered before the decorator.
+                return pointer_policy_t<typename BASE_T::interface_type>::share(BASE_T::inner());
+            }
+            else if constexpr (internal::is_policy_pointer<T>::value)
+            {
+                static_assert(std::is_same_v<T, pointer_t<typename T::element_type>>, "Constructor argument pointer type does not match the pointer_policy of its element type.");
+                return resolve<typename T::element_type>();
+            }
+            else if constexpr (internal::is_lazy<T>::value)
+            {
+                static_assert(std::is_same_v<pointer_policy_t<typename T::element_type>, shared_ownership>, "cpp_di::lazy requires the shared_ownership policy.");
+                return T(&resolve_deferred<typename T::element_type>, container::active, scope::active);
+            }
+            else if constexpr (internal::is_all<T>::value)
+            {
+                return multi_registry<typename T::element_type>::get();
+            }
+            else if constexpr (internal::is_factory<T>::value)
+            {
+                return assisted_factory(static_cast<T*>(nullptr));
+            }
+            else if constexpr (internal::is_pooled<T>::value)
+            {
+                if (internal::failed())
+                {
+                    return T();
+                }
+                return acquire<typename T::element_type>();
+            }
+            else if constexpr (internal::is_keyed<T>::value)
+            {
+                if (internal::failed())
+                {
+                    return T();
+                }
+                return T(registry<typename T::element_type, typename internal::is_keyed<T>::key>::get());
+            }
+            else if constexpr (std::is_pointer_v<T> || std::is_lvalue_reference_v<T>)
+            {
+                // Borrowed from an instance the container keeps alive, no refcounting involved.
+                using element_t = typename internal::dependency_type<T>::type;
+                auto ptr = resolve_ptr<element_t>();
+                if constexpr (std::is_pointer_v<T>)
+                {
+                    return ptr;
+                }
+                else
+                {
+                    return ptr ? *ptr : *reinterpret_cast<element_t*>(internal::unresolved<element_t>);
+                }
+            }
+            else if constexpr (internal::is_unique_ptr<T>::value)
+            {
+                return resolve_unique<typename T::element_type>();
+            }
+            else
+            {
+                fail_type<BASE_T, T>();
+            }
+        }
+
+        template<typename T>
+        static T* resolve_ptr()
+        {
+            if (internal::failed())
+            {
+                return nullptr;
+            }
+            if (auto owner = container::active)
+            {
+                return owner->template get_ptr<T>();
+            }
+            return registry<T>::get_ptr();
+        }
+
+        template<typename T>
+        static std::unique_ptr<T> resolve_unique()
+        {
+            if (internal::failed())
+            {
+                return nullptr;
+            }
+            if (auto owner = container::active)
+            {
+                return owner->template create_unique<T>();
+            }
+            return registry<T>::create_unique();
+        }
+
+        // Dependencies of an object built by a container come from that container.
+        template<typename T>
+        static pointer_t<T> resolve()
+        {
+            if (internal::failed())
+            {
+                return {};
+            }
+            if (auto owner = container::active)
+            {
+                return owner->template get<T>();
+            }
+            return registry<T>::get();
+        }
+
+        template<typename T>
+        static std::shared_ptr<T> resolve_deferred(void* owner, void* active_scope)
+        {
+            if (owner)
+            {
+                return static_cast<container*>(owner)->template get<T>();
+            }
+            if (active_scope)
+            {
+                return static_cast<scope*>(active_scope)->template get<T>();
+            }
+            return registry<T>::get();
+        }
+
+        // Factory a decorator T of INTERFACE_T wraps, the previous constructor of registry<INTERFACE_T>.
+        // Also stands for T as the owner of its constructor arguments.
+        template<typename INTERFACE_T, typename T>
+        struct decoration
+        {
+            using interface_type = INTERFACE_T;
+
+            inline static storage_t<INTERFACE_T> (*inner)() = nullptr;
+        };
+
+        // Whether ARGUMENT_T of the constructor of OWNER_T receives the decorated instance.
+        template<typename OWNER_T, typename ARGUMENT_T> struct is_inner_argument : std::false_type {};
+        template<typename INTERFACE_T, typename T, typename ARGUMENT_T> struct is_inner_argument<decoration<INTERFACE_T, T>, ARGUMENT_T>
+            : std::is_same<ARGUMENT_T, pointer_t<INTERFACE_T>> {};
+
+        // Type-erased factories of di::container. shared_ownership instances are held as they
+        // are, those of other policies in a std::shared_ptr to their storage.
+        template<typename INTERFACE_T, auto FACTORY>
+        static std::shared_ptr<void> erase_factory()
+        {
+            if constexpr (std::is_same_v<pointer_policy_t<INTERFACE_T>, shared_ownership>)
+            {
+                return FACTORY();
+            }
+            else
+            {
+                auto obj = FACTORY();
+                if (!obj)
+                {
+                    return nullptr;
+                }
+                return std::make_shared<storage_t<INTERFACE_T>>(std::move(obj));
+            }
+        }
+
+        // Instance held by a std::shared_ptr<void> from erase_factory<INTERFACE_T>.
+        template<typename INTERFACE_T>
+        static void* erased_instance(void* obj)
+        {
+            if constexpr (std::is_same_v<pointer_policy_t<INTERFACE_T>, shared_ownership>)
+            {
+                return obj;
+            }
+            else
+            {
+                return obj ? pointer_policy_t<INTERFACE_T>::raw(*static_cast<storage_t<INTERFACE_T>*>(obj)) : nullptr;
+            }
+        }
+
+        template<typename INTERFACE_T>
+        static pointer_t<INTERFACE_T> erased_pointer(const std::shared_ptr<void>& obj)
+        {
+            if constexpr (std::is_same_v<pointer_policy_t<INTERFACE_T>, shared_ownership>)
+            {
+                return std::static_pointer_cast<INTERFACE_T>(obj);
+            }
+            else
+            {
+                return obj ? pointer_policy_t<INTERFACE_T>::share(*static_cast<storage_t<INTERFACE_T>*>(obj.get())) : pointer_t<INTERFACE_T>{};
+            }
+        }
+
+        template <typename BASE_T, typename TUPLE_T, size_t... indices>
+        static TUPLE_T construct_tuple(std::index_sequence<indices...>)
+        {
+            // Braced initialization keeps the left-to-right resolution order.
+            return TUPLE_T{ construct_argument<BASE_T, std::tuple_element_t<indices, TUPLE_T>>()... };
+        }
+
+        template <typename BASE_T, typename TUPLE_T>
+        static TUPLE_T construct_tuple()
+        {
+            return construct_tuple<BASE_T, TUPLE_T>(std::make_index_sequence<std::tuple_size_v<TUPLE_T>>());
+        }
+
+        template <class T, class POLICY_T, class ALLOC_T, class TUPLE_T, size_t... indices>
+        constexpr static auto make_from_tuple_impl(TUPLE_T&& tuple, std::index_sequence<indices...>)
+        {
+            return POLICY_T::template make<T, ALLOC_T>(std::get<indices>(std::forward<TUPLE_T>(tuple))...);
+        }
+
+        template<typename T, typename POLICY_T, typename ALLOC_T, typename TUPLE_T>
+        static auto make_from_tuple(TUPLE_T&& tuple)
+        {
+            return make_from_tuple_impl<T, POLICY_T, ALLOC_T>(std::forward<TUPLE_T>(tuple), std::make_index_sequence<std::tuple_size_v<std::remove_reference_t<TUPLE_T>>>{});
+        }
+
+        // Factories stored in registry<INTERFACE_T>::constructor. Being plain function templates
+        // they decay to function pointers, so registration involves no type erasure or allocation.
+        // The pointer_policy of INTERFACE_T decides how the instance is owned.
+        template<typename INTERFACE_T, typename T, typename ALLOC_T = std::allocator<T>>
+        static storage_t<INTERFACE_T> make_default()
+        {
+            using policy_t = pointer_policy_t<INTERFACE_T>;
+
+            CPP_DI_TRACE_SPAN(T);
+            return policy_t::template cast<INTERFACE_T>(policy_t::template make<T, internal::factory_allocator_t<ALLOC_T>>());
+        }
+
+        template<typename INTERFACE_T, typename T, typename ALLOC_T = std::allocator<T>>
+        static storage_t<INTERFACE_T> make_wired()
+        {
+            using ctr_type = constructor_args_t<T>;
+            using policy_t = pointer_policy_t<INTERFACE_T>;
+
+            CPP_DI_TRACE_SPAN(T);
+            auto args = construct_tuple<T, ctr_type>();
+            if (internal::failed())
+            {
+                return {};
+            }
+            return policy_t::template cast<INTERFACE_T>(make_from_tuple<T, policy_t, internal::factory_allocator_t<ALLOC_T>>(std::move(args)));
+        }
+
+        template<typename INTERFACE_T, typename T>
+        static storage_t<INTERFACE_T> make_decorated()
+        {
+            using policy_t = pointer_policy_t<INTERFACE_T>;
+
+            CPP_DI_TRACE_SPAN(T);
+            auto args = construct_tuple<decoration<INTERFACE_T, T>, constructor_args_t<T>>();
+            if (internal::failed())
+            {
+                return {};
+            }
+            return policy_t::template cast<INTERFACE_T>(make_from_tuple<T, policy_t, internal::factory_allocator_t<std::allocator<T>>>(std::move(args)));
+        }
+
+        // Builds T for cpp_di::factory: the runtime arguments fill the leading constructor
+        // parameters, the remaining ones are resolved like those of any registered type.
+        template<typename T, typename... ARGS, size_t... indices>
+        static storage_t<T> make_assisted(std::index_sequence<indices...>, ARGS&&... args)
+        {
+            using ctr_type = constructor_args_t<T>;
+            using policy_t = pointer_policy_t<T>;
+
+            CPP_DI_TRACE_SPAN(T);
+            std::tuple<std::tuple_element_t<sizeof...(ARGS) + indices, ctr_type>...> dependencies{
+                construct_argument<T, std::tuple_element_t<sizeof...(ARGS) + indices, ctr_type>>()... };
+            if (internal::failed())
+            {
+                return {};
+            }
+            return policy_t::template make<T, internal::factory_allocator_t<std::allocator<T>>>(std::forward<ARGS>(args)...,
+                std::get<indices>(std::move(dependencies))...);
+        }
+
+        template<typename T, typename... ARGS>
+        static storage_t<T> make_assisted(ARGS&&... args)
+        {
+            constexpr auto parameters = std::tuple_size_v<constructor_args_t<T>>;
+            static_assert(parameters >= sizeof...(ARGS), "cpp_di::factory has more runtime arguments than the constructor of T has parameters.");
+            return make_assisted<T, ARGS...>(std::make_index_sequence<parameters - sizeof...(ARGS)>(), std::forward<ARGS>(args)...);
+        }
+
+        template<typename T, typename... ARGS>
+        static factory<T, ARGS...> assisted_factory(factory<T, ARGS...>*)
+        {
+            return factory<T, ARGS...>(&make_assisted<T, ARGS...>);
+        }
+
+        // Factory behind std::unique_ptr injection. Plain new, as std::default_delete expects.
+        template<typename INTERFACE_T, typename T>
+        static INTERFACE_T* make_owned()
+        {
+            CPP_DI_TRACE_SPAN(T);
+            if constexpr (std::is_default_constructible_v<T>)
+            {
+                return new T();
+            }
+            else
+            {
+                auto args = construct_tuple<T, constructor_args_t<T>>();
+                if (internal::failed())
+                {
+                    return nullptr;
+                }
+                return std::apply([](auto&&... args) { return new T(std::forward<decltype(args)>(args)...); }, std::move(args));
+            }
+        }
+
+        template<typename INTERFACE_T, typename T, typename ALLOC_T>
+        static constexpr auto make_factory()
+        {
+            if constexpr (std::is_default_constructible_v<T>)
+            {
+                return &make_default<INTERFACE_T, T, ALLOC_T>;
+            }
+            else
+            {
+                return &make_wired<INTERFACE_T, T, ALLOC_T>;
+            }
+        }
+
+        template<typename ARGUMENT_T>
+        static internal::node* dependency_node()
+        {
+            using dependency_t = typename internal::dependency_type<ARGUMENT_T>::type;
+
+            if constexpr (internal::is_all<ARGUMENT_T>::value)
+            {
+                return &multi_registry<typename ARGUMENT_T::element_type>::info;
+            }
+            else if constexpr (internal::is_pooled<ARGUMENT_T>::value)
+            {
+                return &registry<typename ARGUMENT_T::element_type>::info;
+            }
+            else if constexpr (internal::is_keyed<ARGUMENT_T>::value)
+            {
+                return &registry<typename ARGUMENT_T::element_type, typename internal::is_keyed<ARGUMENT_T>::key>::info;
+            }
+            else if constexpr (!std::is_void_v<dependency_t>)
+            {
+                return &registry<dependency_t>::info;
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+
+        template<typename TUPLE_T, size_t... indices>
+        static std::vector<internal::node*> dependencies(std::index_sequence<indices...>)
+        {
+            std::vector<internal::node*> result;
+            for (auto dependency : { static_cast<internal::node*>(nullptr), dependency_node<std::tuple_element_t<indices, TUPLE_T>>()... })
+            {
+                if (dependency)
+                {
+                    result.push_back(dependency);
+                }
+            }
+            return result;
+        }
+
+        template<typename T>
+        static std::vector<internal::node*> dependencies()
+        {
+            if constexpr (std::is_default_constructible_v<T>)
+            {
+                return {};
+            }
+            else
+            {
+                using ctr_type = constructor_args_t<T>;
+                return dependencies<ctr_type>(std::make_index_sequence<std::tuple_size_v<ctr_type>>());
+            }
+        }
+
+        inline static std::vector<internal::node*> nodes;
+        // Serializes registration, which is otherwise a check-then-set of registry statics.
+        // Recursive so that di::install can hold it across the modules it runs.
+        inline static std::recursive_mutex registration;
+
+        // The first registration of INTERFACE_T under KEY_T wins, later ones are ignored.
+        template<typename INTERFACE_T, typename T, typename KEY_T = void, typename FACTORY_T>
+        static bool bind(lifetime kind, FACTORY_T factory)
+        {
+            using registry_t = registry<INTERFACE_T, KEY_T>;
+
+            std::lock_guard lock(registration);
+            if (registry_t::constructor)
+            {
+                return false;
+            }
+
+            registry_t::kind = kind;
+            registry_t::constructor = factory;
+            registry_t::info.kind = kind;
+            registry_t::info.disposable = trivially_disposable<T>::value;
+            registry_t::info.dependencies = dependencies<T>();
+            registry_t::info.name = internal::type_name<INTERFACE_T>();
+            registry_t::info.size = sizeof(T);
+            if constexpr (!std::is_void_v<KEY_T>)
+            {
+                registry_t::info.key = KEY_T::value;
+            }
+#ifdef CPP_DI_SHARED_REGISTRY
+            if constexpr (std::is_same_v<pointer_policy_t<INTERFACE_T>, shared_ownership>)
+            {
+                if (kind == lifetime::singleton)
+                {
+                    registry_t::publish_factory();
+                }
+            }
+#endif
+            nodes.push_back(&registry_t::info);
+            return true;
+        }
+
+        template<typename MODULE_T, typename = void>
+        struct is_binding_module : std::false_type {};
+
+        template<typename MODULE_T>
+        struct is_binding_module<MODULE_T, std::void_t<typename MODULE_T::interface_type, typename MODULE_T::type>> : std::true_type {};
+
+        template<typename MODULE_T>
+        static void install_module()
+        {
+            if constexpr (is_binding_module<MODULE_T>::value)
+            {
+                type_registry::set_type<typename MODULE_T::interface_type>();
+                add<typename MODULE_T::interface_type, typename MODULE_T::type>();
+            }
+            else
+            {
+                MODULE_T::install();
+            }
+        }
+
+        // Failures anywhere in the graph below T come back as their errc: thrown ones are
+        // caught, and without exceptions internal::fail records them in a slot of this thread
+        // while the factories unwind by returning empty.
+        template<typename REGISTRY_T>
+        static result<typename REGISTRY_T::pointer> try_resolve()
+        {
+#ifndef CPP_DI_NO_EXCEPTIONS
+            try
+            {
+                if (auto ptr = REGISTRY_T::get())
+                {
+                    return ptr;
+                }
+            }
+            catch (const error& e)
+            {
+                return e.code();
+            }
+            catch (...)
+            {
+            }
+#else
+            errc failure = errc::none;
+            internal::failure_scope guard(failure);
+            auto ptr = REGISTRY_T::get();
+            if (failure != errc::none)
+            {
+                return failure;
+            }
+            if (ptr)
+            {
+                return ptr;
+            }
+#endif
+            return errc::construction_failed;
+        }
+
+        // Dependency counters over the singleton DAG. Forward, a node is submitted to the executor
+        // once all of its dependencies are done, which is the construction order. Reversed, once
+        // all of its dependents are done, which is the teardown order.
+        struct schedule_state
+        {
+            std::vector<internal::node*> order;
+            std::vector<std::vector<std::size_t>> successors;
+            std::unique_ptr<std::atomic<std::size_t>[]> pending;
+            std::atomic<std::size_t> remaining{ 0 };
+
+            void (*action)(internal::node*, shutdown_mode) = nullptr;
+            shutdown_mode mode = shutdown_mode::destroy;
+
+            void* executor = nullptr;
+            void (*submit)(void* executor, schedule_state* state, std::size_t index) = nullptr;
+
+            std::mutex mutex;
+            std::condition_variable done;
+            std::exception_ptr error;
+
+            // Registrations the registry holds instances of: singletons and, for teardown only,
+            // replicated ones, whose replicas are built by threads of their own node.
+            static bool scheduled(const internal::node* node, bool reverse)
+            {
+                return node->kind == lifetime::singleton || (reverse && node->kind == lifetime::replicated);
+            }
+
+            // Collects scheduled dependencies of node, looking through the others since those
+            // are rebuilt by every dependent anyway.
+            static void singleton_dependencies(internal::node* node, bool reverse, std::vector<internal::node*>& result, std::vector<internal::node*>& visited)
+            {
+                for (auto dependency : node->dependencies)
+                {
+                    if (std::find(visited.begin(), visited.end(), dependency) != visited.end())
+                    {
+                        continue;
+                    }
+                    visited.push_back(dependency);
+
+                    if (scheduled(dependency, reverse))
+                    {
+                        result.push_back(dependency);
+                    }
+                    else
+                    {
+                        singleton_dependencies(dependency, reverse, result, visited);
+                    }
+                }
+            }
+
+            schedule_state(const std::vector<internal::node*>& registered, bool reverse)
+            {
+                std::unordered_map<internal::node*, std::size_t> index;
+                for (auto node : registered)
+                {
+                    if (scheduled(node, reverse))
+                    {
+                        index.emplace(node, order.size());
+                        order.push_back(node);
+                    }
+                }
+
+                successors.resize(order.size());
+                pending = std::make_unique<std::atomic<std::size_t>[]>(order.size());
+                remaining = order.size();
+
+                for (std::size_t i = 0; i < order.size(); i++)
+                {
+                    std::vector<internal::node*> edges, visited;
+                    singleton_dependencies(order[i], reverse, edges, visited);
+
+                    for (auto dependency : edges)
+                    {
+                        if (auto it = index.find(dependency); it != index.end())
+                        {
+                            auto from = reverse ? i : it->second;
+                            auto to = reverse ? it->second : i;
+                            successors[from].push_back(to);
+                            pending[to]++;
+                        }
+                    }
+                }
+            }
+
+            void run(std::size_t index)
+            {
+#ifndef CPP_DI_NO_EXCEPTIONS
+                try
+                {
+                    action(order[index], mode);
+                }
+                catch (...)
+                {
+                    std::lock_guard lock(mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+#else
+                action(order[index], mode);
+#endif
+
+                for (auto successor : successors[index])
+                {
+                    if (pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    {
+                        submit(executor, this, successor);
+                    }
+                }
+
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    std::lock_guard lock(mutex);
+                    done.notify_all();
+                }
+            }
+
+            void start()
+            {
+                // Roots are collected up front: an inline executor may already have released
+                // their successors by the time the loop reaches them.
+                std::vector<std::size_t> roots;
+                for (std::size_t i = 0; i < order.size(); i++)
+                {
+                    if (pending[i].load(std::memory_order_relaxed) == 0)
+                    {
+                        roots.push_back(i);
+                    }
+                }
+
+                for (auto root : roots)
+                {
+                    submit(executor, this, root);
+                }
+            }
+
+            void wait()
+            {
+                std::unique_lock lock(mutex);
+                done.wait(lock, [this]() { return remaining.load(std::memory_order_acquire) == 0; });
+#ifndef CPP_DI_NO_EXCEPTIONS
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+#endif
+            }
+        };
+
+        struct schedule_task
+        {
+            schedule_state* state;
+            std::size_t index;
+
+            void operator()() const { state->run(index); }
+        };
+
+        // Fixed set of workers draining a shared queue, used when no executor is given.
+        class schedule_pool
+        {
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::deque<schedule_task> tasks;
+            bool stopping = false;
+            std::vector<std::thread> workers;
+        public:
+            explicit schedule_pool(std::size_t threads)
+            {
+                for (std::size_t i = 0; i < threads; i++)
+                {
+                    workers.emplace_back([this]()
+                    {
+                        while (true)
+                        {
+                            std::unique_lock lock(mutex);
+                            ready.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                            if (tasks.empty())
+                            {
+                                return;
+                            }
+
+                            auto task = tasks.front();
+                            tasks.pop_front();
+                            lock.unlock();
+                            task();
+                        }
+                    });
+                }
+            }
+
+            ~schedule_pool()
+            {
+                {
+                    std::lock_guard lock(mutex);
+                    stopping = true;
+                }
+                ready.notify_all();
+                for (auto& worker : workers)
+                {
+                    worker.join();
+                }
+            }
+
+            void operator()(schedule_task task)
+            {
+                {
+                    std::lock_guard lock(mutex);
+                    tasks.push_back(task);
+                }
+                ready.notify_one();
+            }
+        };
+
+        template<typename EXECUTOR_T>
+        static void schedule(schedule_state& state, EXECUTOR_T& executor)
+        {
+            using executor_t = std::remove_reference_t<EXECUTOR_T>;
+
+            state.executor = const_cast<void*>(static_cast<const void*>(std::addressof(executor)));
+            state.submit = [](void* e, schedule_state* s, std::size_t index) { (*static_cast<executor_t*>(e))(schedule_task{ s, index }); };
+            state.start();
+            state.wait();
+        }
+
+        // Implementations bound to INTERFACE_T through add_all. Each one is an ordinary singleton
+        // registration of its own type; this only gathers them into one array.
+        template<typename INTERFACE_T>
+        class multi_registry
+        {
+            using element_t = std::shared_ptr<INTERFACE_T>;
+
+            inline static std::vector<element_t (*)()> members;
+            inline static internal::once_flag flag;
+            inline static all<INTERFACE_T> obj;
+            inline static std::atomic<bool> ready{ false };
+
+            template<typename T>
+            static element_t member()
+            {
+                return registry<T>::get();
+            }
+
+            static void construct()
+            {
+                internal::call_once(flag, +[]()
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    auto items = std::make_shared<element_t[]>(members.size());
+                    for (std::size_t i = 0; i < members.size(); i++)
+                    {
+                        items[i] = members[i]();
+                    }
+                    if (internal::failed())
+                    {
+                        return;
+                    }
+                    obj = all<INTERFACE_T>(std::move(items), members.size());
+                    info.construction_time = std::chrono::steady_clock::now() - start;
+                    ready.store(true, std::memory_order_release);
+                });
+            }
+
+            static void release(bool)
+            {
+                if (ready.exchange(false, std::memory_order_acq_rel))
+                {
+                    obj = all<INTERFACE_T>();
+                }
+            }
+
+            static bool constructed()
+            {
+                return ready.load(std::memory_order_acquire);
+            }
+
+            static long use_count()
+            {
+                return constructed() ? obj.items.use_count() : 0;
+            }
+
+            inline static internal::node info{ []() { construct(); }, &release, &constructed, &use_count };
+
+            template<typename... TS>
+            static void bind()
+            {
+                std::lock_guard lock(registration);
+                if (ready.load(std::memory_order_acquire))
+                {
+                    internal::raise(errc::already_resolved, "Multi-binding extended after it was resolved.");
+                }
+
+                if (members.empty())
+                {
+                    info.name = internal::type_name<all<INTERFACE_T>>();
+                    nodes.push_back(&info);
+                }
+
+                members.reserve(members.size() + sizeof...(TS));
+                info.size = sizeof(element_t) * (members.size() + sizeof...(TS));
+                (members.push_back(&member<TS>), ...);
+                (info.dependencies.push_back(&registry<TS>::info), ...);
+            }
+
+            static all<INTERFACE_T> get()
+            {
+                if (!ready.load(std::memory_order_acquire))
+                {
+                    construct();
+                }
+                return obj;
+            }
+
+            friend class di;
+        };
+
+        // Idle instances of a pooled registration, split into shards so threads mostly touch
+        // their own. Each shard is a fixed array of slots claimed and filled with a single atomic
+        // exchange or compare-exchange, which keeps it lock-free without ABA hazards. A thread
+        // that finds its shard empty steals from the others before building a new instance.
+        template<typename T>
+        class pool
+        {
+            static constexpr std::size_t per_line = 64 / sizeof(std::atomic<T*>);
+
+            struct alignas(64) line
+            {
+                std::atomic<T*> slots[per_line]{};
+            };
+
+            // The slots of a shard occupy whole cache lines of their own, so that threads working
+            // on neighbouring shards never contend for a line.
+            struct shard
+            {
+                std::unique_ptr<line[]> lines;
+
+                std::atomic<T*>& operator[](std::size_t i) noexcept
+                {
+                    return lines[i / per_line].slots[i % per_line];
+                }
+
+                ~shard()
+                {
+                    for (std::size_t i = 0; lines && i < shard_capacity; i++)
+                    {
+                        delete (*this)[i].load(std::memory_order_relaxed);
+                    }
+                }
+            };
+
+            inline static std::size_t shard_count = 0;
+            inline static std::size_t shard_capacity = 0;
+            inline static std::unique_ptr<shard[]> shards;
+            inline static pool_options options;
+            inline static void (*reset)(T&) = nullptr;
+            inline static internal::once_flag flag;
+            inline static std::atomic<std::size_t> threads{ 0 };
+
+            static std::size_t home()
+            {
+                thread_local const std::size_t id = threads.fetch_add(1, std::memory_order_relaxed);
+                return id % shard_count;
+            }
+
+            static void configure(pool_options configured, void (*configured_reset)(T&))
+            {
+                options = configured;
+                reset = configured_reset;
+
+                std::size_t cores = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+                shard_count = std::max<std::size_t>(std::min(cores, options.capacity), 1);
+                shard_capacity = (options.capacity + shard_count - 1) / shard_count;
+                shards = std::make_unique<shard[]>(shard_count);
+                for (std::size_t i = 0; i < shard_count; i++)
+                {
+                    shards[i].lines = std::make_unique<line[]>((shard_capacity + per_line - 1) / per_line);
+                }
+            }
+
+            static void fill()
+            {
+                internal::call_once(flag, +[]()
+                {
+                    for (std::size_t i = 0; i < std::min(options.prefill, options.capacity); i++)
+                    {
+                        give(registry<T>::owned_constructor());
+                    }
+                });
+            }
+
+            static T* take()
+            {
+                if (registry<T>::kind != lifetime::pooled)
+                {
+                    internal::fail(errc::wrong_lifetime, "cpp_di: acquired type is not pooled");
+                    return nullptr;
+                }
+                fill();
+
+                auto first = home();
+                for (std::size_t n = 0; n < shard_count; n++)
+                {
+                    auto& slots = shards[(first + n) % shard_count];
+                    for (std::size_t i = 0; i < shard_capacity; i++)
+                    {
+                        if (slots[i].load(std::memory_order_relaxed))
+                        {
+                            if (auto ptr = slots[i].exchange(nullptr, std::memory_order_acquire))
+                            {
+                                return ptr;
+                            }
+                        }
+                    }
+                }
+                return registry<T>::owned_constructor();
+            }
+
+            static void give(T* ptr)
+            {
+                if (reset)
+                {
+                    reset(*ptr);
+                }
+
+                auto first = home();
+                for (std::size_t n = 0; n < shard_count; n++)
+                {
+                    auto& slots = shards[(first + n) % shard_count];
+                    for (std::size_t i = 0; i < shard_capacity; i++)
+                    {
+                        T* expected = nullptr;
+                        if (!slots[i].load(std::memory_order_relaxed) && slots[i].compare_exchange_strong(expected, ptr, std::memory_order_release, std::memory_order_relaxed))
+                        {
+                            return;
+                        }
+                    }
+                }
+                delete ptr;
+            }
+
+            friend class di;
+        };
+    public:
+
+
+        // KEY_T is void, or internal::key_tag for keyed registrations.
+        template<typename T, typename KEY_T = void, typename POLICY_T = pointer_policy_t<T>, typename CNSTR_T = typename POLICY_T::template storage<T>(*)()>
+        class registry
+        {
+        public:
+            using storage = typename POLICY_T::template storage<T>;
+            using pointer = typename POLICY_T::template pointer<T>;
+        private:
+            // Each on a cache line of its own: every resolution of T reads them, and waiters of
+            // a cold T wait on flag, so neither may share a line with the statics of other types.
+            inline static internal::cache_line<internal::once_flag> flag;
+            inline static storage obj;
+            // Published after obj is constructed. Once set, obj is never written again,
+            // so readers that observe it may skip call_once entirely.
+            inline static internal::cache_line<std::atomic<T*>> instance{ nullptr };
+
+            // hot_swappable types only: the storage get() copies from, &obj until the first
+            // replacement. A cell is never written while published.
+            inline static std::atomic<storage*> current{ &obj };
+            inline static const storage empty{};
+            inline static std::mutex swap_mutex;
+
+            inline static pointer read()
+            {
+                return internal::swap_readers::read(current, [](const storage& cell) { return POLICY_T::share(cell); });
+            }
+
+            // Unpublishes the current cell in favour of next and hands the old content back once
+            // no reader can still be copying it. empty, current after shutdown, holds nothing and
+            // is neither moved from nor freed.
+            inline static storage exchange(storage* next)
+            {
+                auto previous = current.exchange(next, std::memory_order_seq_cst);
+                internal::swap_readers::synchronize();
+
+                if (previous == &empty)
+                {
+                    return storage{};
+                }
+                storage result = std::move(*previous);
+                if (previous != &obj)
+                {
+                    delete previous;
+                }
+                return result;
+            }
+
+            inline static void publish(storage replacement)
+            {
+                if (kind != lifetime::singleton)
+                {
+                    internal::raise(errc::wrong_lifetime, "cpp_di: only singletons can be replaced");
+                }
+
+                // A replacement published before first use stands in for the registered factory.
+                // It becomes obj within the once-callable, so resolutions waiting on flag see it.
+                bool first = false;
+                internal::call_once(flag, +[](storage* replacement, bool* first)
+                {
+                    obj = std::move(*replacement);
+                    instance.store(POLICY_T::raw(obj), std::memory_order_release);
+                    *first = true;
+                }, &replacement, &first);
+                if (first)
+                {
+                    return;
+                }
+
+                // Destroyed on return unless other owners still hold it.
+                storage previous;
+                std::lock_guard lock(swap_mutex);
+                auto raw = POLICY_T::raw(replacement);
+                previous = exchange(new storage(std::move(replacement)));
+                instance.store(raw, std::memory_order_release);
+            }
+
+            inline static T* construct()
+            {
+                internal::call_once(flag, +[]()
+                {
+                    auto start = std::chrono::steady_clock::now();
+#ifdef CPP_DI_SHARED_REGISTRY
+                    if constexpr (std::is_same_v<POLICY_T, shared_ownership>)
+                    {
+                        obj = construct_shared();
+                    }
+                    else
+#endif
+                    obj = build();
+                    info.construction_time = std::chrono::steady_clock::now() - start;
+                    instance.store(POLICY_T::raw(obj), std::memory_order_release);
+                });
+                return instance.load(std::memory_order_acquire);
+            }
+
+#ifdef CPP_DI_SHARED_REGISTRY
+            // Slot of this registration in the table shared across modules, looked up and
+            // cached by the first registration or resolution in this module.
+            inline static internal::shared_slot* shared = nullptr;
+
+            inline static internal::shared_slot& shared_slot()
+            {
+                if (!shared)
+                {
+                    shared = &internal::shared_registry().slot(internal::type_name<registry>());
+                }
+                return *shared;
+            }
+
+            inline static std::shared_ptr<void> erased_constructor()
+            {
+                return build();
+            }
+
+            inline static void publish_factory()
+            {
+                std::shared_ptr<void> (*none)() = nullptr;
+                shared_slot().factory.compare_exchange_strong(none, &erased_constructor, std::memory_order_acq_rel);
+            }
+
+            // The instance every module shares, built by whichever module resolves it first
+            // with the factory registered first, possibly by another module.
+            inline static storage construct_shared()
+            {
+                auto& slot = shared_slot();
+                internal::call_once(slot.flag, +[](internal::shared_slot* slot)
+                {
+                    auto factory = slot->factory.load(std::memory_order_acquire);
+                    if (!factory)
+                    {
+                        internal::fail(errc::not_registered, "cpp_di: singleton is not registered in any module");
+                        return;
+                    }
+                    slot->obj = factory();
+                }, &slot);
+                return std::static_pointer_cast<T>(slot.obj);
+            }
+#endif
+
+        public:
+            inline static CNSTR_T constructor;
+
+            // Runs the registered factory. Every instance of T is built through here, so that
+            // resolving a type nobody registered, e.g. a missing dependency, is reported rather
+            // than calling a null factory.
+            inline static storage build()
+            {
+                if (!constructor)
+                {
+                    internal::fail(errc::not_registered, "cpp_di: type is not registered");
+                    return {};
+                }
+                return constructor();
+            }
+            // Set for transient registrations, which may also be injected as std::unique_ptr.
+            inline static T* (*owned_constructor)() = nullptr;
+            inline static lifetime kind = lifetime::singleton;
+            // Raw storage obj is moved into when abandoned at shutdown, never destroyed.
+            alignas(storage) inline static unsigned char abandoned[sizeof(storage)];
+
+            inline static void release(bool abandon)
+            {
+                if (kind == lifetime::replicated)
+                {
+                    release_replicas(abandon);
+                    return;
+                }
+                if (!instance.load(std::memory_order_acquire))
+                {
+                    return;
+                }
+
+                instance.store(nullptr, std::memory_order_release);
+#ifdef CPP_DI_SHARED_REGISTRY
+                // Singletons are process-wide, so is their shutdown.
+                if constexpr (std::is_same_v<POLICY_T, shared_ownership>)
+                {
+                    shared_slot().obj.reset();
+                }
+#endif
+                if constexpr (hot_swappable<T>::value)
+                {
+                    std::lock_guard lock(swap_mutex);
+                    auto last = exchange(const_cast<storage*>(&empty));
+                    if (abandon)
+                    {
+                        ::new (static_cast<void*>(abandoned)) storage(std::move(last));
+                    }
+                    return;
+                }
+                if (abandon)
+                {
+                    ::new (static_cast<void*>(abandoned)) storage(std::move(obj));
+                }
+                obj = storage{};
+            }
+
+            inline static bool constructed()
+            {
+                if (kind == lifetime::replicated)
+                {
+                    for (std::size_t i = 0; i < CPP_DI_MAX_NUMA_NODES; i++)
+                    {
+                        if (replicas[i].instance.load(std::memory_order_acquire))
+                        {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+                return instance.load(std::memory_order_acquire) != nullptr;
+            }
+
+            // Owners of the instance including the registry, 1 when the pointer type keeps no count.
+            inline static long use_count()
+            {
+                if (kind == lifetime::replicated)
+                {
+                    // Summed over the replicas built so far.
+                    long count = 0;
+                    for (std::size_t i = 0; i < CPP_DI_MAX_NUMA_NODES; i++)
+                    {
+                        if (replicas[i].instance.load(std::memory_order_acquire))
+                        {
+                            if constexpr (internal::has_use_count<storage>::value)
+                            {
+                                count += static_cast<long>(replicas[i].obj.use_count());
+                            }
+                            else
+                            {
+                                count++;
+                            }
+                        }
+                    }
+                    return count;
+                }
+                if constexpr (internal::has_use_count<storage>::value)
+                {
+                    if constexpr (hot_swappable<T>::value)
+                    {
+                        std::lock_guard lock(swap_mutex);
+                        return constructed() ? static_cast<long>(current.load(std::memory_order_acquire)->use_count()) : 0;
+                    }
+                    return constructed() ? static_cast<long>(obj.use_count()) : 0;
+                }
+                else
+                {
+                    return constructed() ? 1 : 0;
+                }
+            }
+
+            inline static internal::node info{ []() { construct(); }, &release, &constructed, &use_count };
+
+            // per_thread registrations only. Touched by the owning thread alone, so no
+            // synchronization is involved.
+            inline static thread_local storage local;
+
+            inline static T* construct_local()
+            {
+                if (!local)
+                {
+                    local = build();
+                }
+                return POLICY_T::raw(local);
+            }
+
+            // replicated registrations only, allocated when registered. Each replica is built
+            // by a thread of its node, so with the default first-touch policy its memory is local.
+            struct alignas(64) replica
+            {
+                internal::once_flag flag;
+                storage obj;
+                std::atomic<T*> instance{ nullptr };
+                alignas(storage) unsigned char abandoned[sizeof(storage)];
+            };
+
+            inline static std::unique_ptr<replica[]> replicas;
+
+            // As release, for every replica built so far.
+            inline static void release_replicas(bool abandon)
+            {
+                for (std::size_t i = 0; i < CPP_DI_MAX_NUMA_NODES; i++)
+                {
+                    auto& local = replicas[i];
+                    if (!local.instance.exchange(nullptr, std::memory_order_acq_rel))
+                    {
+                        continue;
+                    }
+                    if (abandon)
+                    {
+                        ::new (static_cast<void*>(local.abandoned)) storage(std::move(local.obj));
+                    }
+                    local.obj = storage{};
+                }
+            }
+
+            inline static replica& construct_replica()
+            {
+                auto& local = replicas[internal::numa_node()];
+                if (!local.instance.load(std::memory_order_acquire))
+                {
+                    internal::call_once(local.flag, +[](replica* local)
+                    {
+                        local->obj = build();
+                        local->instance.store(POLICY_T::raw(local->obj), std::memory_order_release);
+                    }, &local);
+                }
+                return local;
+            }
+
+            inline static pointer get()
+            {
+                if (!instance.load(std::memory_order_acquire))
+                {
+                    if (kind == lifetime::replicated)
+                    {
+                        return POLICY_T::share(construct_replica().obj);
+                    }
+                    if (kind == lifetime::per_thread)
+                    {
+                        construct_local();
+                        return POLICY_T::share(local);
+                    }
+                    if (kind == lifetime::pooled)
+                    {
+                        internal::fail(errc::wrong_lifetime, "cpp_di: pooled instances are obtained through di::acquire");
+                        return {};
+                    }
+                    if constexpr (POLICY_T::allows_transient)
+                    {
+                        if (kind == lifetime::transient)
+                        {
+                            return POLICY_T::share(build());
+                        }
+                    }
+                    if constexpr (std::is_same_v<POLICY_T, shared_ownership>)
+                    {
+                        if (kind == lifetime::scoped)
+                        {
+                            auto active = scope::resolving();
+                            return active ? active->template resolve<T>() : pointer{};
+                        }
+                    }
+                    construct();
+                }
+                if constexpr (hot_swappable<T>::value)
+                {
+                    return read();
+                }
+                else
+                {
+                    return POLICY_T::share(obj);
+                }
+            }
+
+            // Non-owning access, valid for as long as the registry holds the instance.
+            // After the first construction this is a single acquire load.
+            inline static T* get_ptr()
+            {
+                if (auto ptr = instance.load(std::memory_order_acquire))
+                {
+                    return ptr;
+                }
+                if (kind == lifetime::transient || kind == lifetime::pooled)
+                {
+                    internal::fail(errc::wrong_lifetime, "cpp_di: transient instances cannot be borrowed");
+                    return nullptr;
+                }
+                if (kind == lifetime::per_thread)
+                {
+                    // Valid until the calling thread exits.
+                    return construct_local();
+                }
+                if (kind == lifetime::replicated)
+                {
+                    return construct_replica().instance.load(std::memory_order_relaxed);
+                }
+                if constexpr (std::is_same_v<POLICY_T, shared_ownership>)
+                {
+                    if (kind == lifetime::scoped)
+                    {
+                        auto active = scope::resolving();
+                        return active ? active->template resolve<T>().get() : nullptr;
+                    }
+                }
+                return construct();
+            }
+
+            inline static std::unique_ptr<T> create_unique()
+            {
+                if (!owned_constructor)
+                {
+                    internal::fail(errc::wrong_lifetime, "cpp_di: std::unique_ptr injection requires a transient registration");
+                    return nullptr;
+                }
+                return std::unique_ptr<T>(owned_constructor());
+            }
+
+            friend class di;
+        };
+
+        // Owner of scoped-lifetime instances, e.g. one per request. Scoped objects and their
+        // control blocks are placed in a monotonic arena which is released in one go when the
+        // scope is destroyed; objects are destroyed in reverse construction order beforehand.
+        // Singletons are still taken from registry<T>. Instances handed out by a scope must not
+        // outlive it.
+        class scope
+        {
+            struct entry
+            {
+                const void* type;
+                std::shared_ptr<void> obj;
+            };
+
+            // Makes the scope current for the calling thread while a resolution is in flight,
+            // so scoped dependencies found by construct_tuple land in the same scope.
+            struct activation
+            {
+                scope* previous;
+
+                explicit activation(scope* s) : previous(active) { active = s; }
+                ~activation() { active = previous; }
+            };
+
+            inline static thread_local scope* active = nullptr;
+
+            std::pmr::monotonic_buffer_resource arena;
+            std::pmr::vector<entry> entries{ &arena };
+
+            static scope& current()
+            {
+                if (!active)
+                {
+                    internal::raise(errc::outside_scope, "cpp_di: scoped type resolved outside of a scope");
+                }
+                return *active;
+            }
+
+            // The active scope, or nullptr once errc::outside_scope has been reported.
+            static scope* resolving()
+            {
+                if (!active)
+                {
+                    internal::fail(errc::outside_scope, "cpp_di: scoped type resolved outside of a scope");
+                }
+                return active;
+            }
+
+            template<typename T>
+            std::shared_ptr<T> resolve()
+            {
+                // The address of a per-type static serves as the type key.
+                const void* type = &registry<T>::kind;
+                for (auto& e : entries)
+                {
+                    if (e.type == type)
+                    {
+                        return std::static_pointer_cast<T>(e.obj);
+                    }
+                }
+
+                auto obj = registry<T>::build();
+                entries.push_back({ type, obj });
+                return obj;
+            }
+
+            template<typename, typename, typename, typename>
+            friend class registry;
+            friend class di;
+        public:
+            template<typename T>
+            struct allocator : std::pmr::polymorphic_allocator<T>
+            {
+                allocator() : std::pmr::polymorphic_allocator<T>(&current().arena) {}
+
+                template<typename U>
+                allocator(const allocator<U>& other) : std::pmr::polymorphic_allocator<T>(other.resource()) {}
+            };
+
+            explicit scope(std::size_t initial_size = 1024) : arena(initial_size) { entries.reserve(8); }
+            scope(void* buffer, std::size_t size) : arena(buffer, size) { entries.reserve(8); }
+
+            ~scope()
+            {
+                while (!entries.empty())
+                {
+                    entries.pop_back();
+                }
+            }
+
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+
+            template<typename T>
+            std::shared_ptr<T> get()
+            {
+                type_registry::check_type<T>();
+                activation guard(this);
+                return registry<T>::get();
+            }
+        };
+
+        // Self-contained set of registrations with its own instances, independent of registry<T>
+        // and of other containers. Each type owns a cache-line sized slot in a dense array
+        // addressed by internal::type_index<T>(), so a lookup is an index plus one acquire load
+        // and containers used from different cores share no state. Registration must be
+        // complete before the container is used concurrently. Every pointer_policy is supported;
+        // a container confined to one thread is the natural owner of local_ownership types.
+        class container
+        {
+            struct alignas(64) slot
+            {
+                std::atomic<void*> instance{ nullptr };
+                std::shared_ptr<void> obj;
+                std::shared_ptr<void> (*constructor)() = nullptr;
+                void* (*owned_constructor)() = nullptr;
+                void* (*instance_of)(void*) = nullptr;
+                lifetime kind = lifetime::singleton;
+
+                slot() = default;
+
+                slot(slot&& other) noexcept
+                    : instance(other.instance.load(std::memory_order_relaxed))
+                    , obj(std::move(other.obj))
+                    , constructor(other.constructor)
+                    , owned_constructor(other.owned_constructor)
+                    , instance_of(other.instance_of)
+                    , kind(other.kind)
+                {
+                }
+            };
+
+            struct activation
+            {
+                container* previous;
+
+                explicit activation(container* c) : previous(active) { active = c; }
+                ~activation() { active = previous; }
+            };
+
+            inline static thread_local container* active = nullptr;
+
+            std::vector<slot> slots;
+            std::vector<std::size_t> registration_order;
+            std::recursive_mutex construction;
+
+            template<typename T>
+            slot& slot_of()
+            {
+                auto index = internal::type_index<T>();
+                if (index >= slots.size() || !slots[index].constructor)
+                {
+                    internal::raise(errc::not_registered, "cpp_di: type is not registered in this container");
+                }
+                return slots[index];
+            }
+
+            std::shared_ptr<void> build(slot& s)
+            {
+                activation guard(this);
+                if (s.kind == lifetime::transient)
+                {
+                    return s.constructor();
+                }
+
+                std::lock_guard lock(construction);
+                if (!s.instance.load(std::memory_order_relaxed))
+                {
+                    s.obj = s.constructor();
+                    s.instance.store(s.instance_of(s.obj.get()), std::memory_order_release);
+                }
+                return s.obj;
+            }
+
+            template<typename INTERFACE_T>
+            void bind(lifetime kind, std::shared_ptr<void> (*constructor)(), void* (*owned_constructor)() = nullptr)
+            {
+                auto index = internal::type_index<INTERFACE_T>();
+                if (index >= slots.size())
+                {
+                    slots.resize(index + 1);
+                }
+
+                auto& s = slots[index];
+                if (s.constructor)
+                {
+                    return;
+                }
+
+                s.kind = kind;
+                s.constructor = constructor;
+                s.owned_constructor = owned_constructor;
+                s.instance_of = &erased_instance<INTERFACE_T>;
+                registration_order.push_back(index);
+            }
+
+            template<typename T>
+            std::unique_ptr<T> create_unique()
+            {
+                auto& s = slot_of<T>();
+                if (!s.owned_constructor)
+                {
+                    internal::raise(errc::wrong_lifetime, "cpp_di: std::unique_ptr injection requires a transient registration");
+                }
+
+                activation guard(this);
+                return std::unique_ptr<T>(static_cast<T*>(s.owned_constructor()));
+            }
+
+            friend class di;
+        public:
+            container() = default;
+
+            ~container()
+            {
+                for (auto it = registration_order.rbegin(); it != registration_order.rend(); ++it)
+                {
+                    slots[*it].obj.reset();
+                }
+            }
+
+            container(const container&) = delete;
+            container& operator=(const container&) = delete;
+
+            template<typename INTERFACE_T, typename T = INTERFACE_T, std::enable_if_t<std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>, bool> = true>
+            void add()
+            {
+                bind<INTERFACE_T>(lifetime::singleton, &erase_factory<INTERFACE_T, make_factory<INTERFACE_T, T, std::allocator<T>>()>);
+            }
+
+            template<typename INTERFACE_T, typename T = INTERFACE_T, typename ALLOC_T = std::allocator<T>, std::enable_if_t<std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>, bool> = true>
+            void add_transient()
+            {
+                static_assert(pointer_policy_t<INTERFACE_T>::allows_transient, "The pointer_policy of INTERFACE_T cannot hand out transient instances.");
+                static_assert(std::is_same_v<INTERFACE_T, T> || std::has_virtual_destructor_v<INTERFACE_T>, "Instances of T are deleted through INTERFACE_T*, which needs a virtual destructor.");
+                bind<INTERFACE_T>(lifetime::transient, &erase_factory<INTERFACE_T, make_factory<INTERFACE_T, T, ALLOC_T>()>,
+                    []() -> void* { return make_owned<INTERFACE_T, T>(); });
+            }
+
+            template<typename T>
+            pointer_t<T> get()
+            {
+                auto& s = slot_of<T>();
+                if (s.instance.load(std::memory_order_acquire))
+                {
+                    return erased_pointer<T>(s.obj);
+                }
+                return erased_pointer<T>(build(s));
+            }
+
+            template<typename T>
+            T* get_ptr()
+            {
+                auto& s = slot_of<T>();
+                if (auto ptr = s.instance.load(std::memory_order_acquire))
+                {
+                    return static_cast<T*>(ptr);
+                }
+                if (s.kind == lifetime::transient)
+                {
+                    internal::raise(errc::wrong_lifetime, "cpp_di: transient instances cannot be borrowed");
+                }
+                build(s);
+                return static_cast<T*>(s.instance.load(std::memory_order_acquire));
+            }
+
+            template<typename T>
+            T& get_ref()
+            {
+                return *get_ptr<T>();
+            }
+        };
+
+        template<typename INTERFACE_T, typename T, std::enable_if_t<(std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>) && std::is_default_constructible_v<T>, bool> = true>
+        static void add()
+        {
+            type_registry::set_type<INTERFACE_T>();
+            bind<INTERFACE_T, T>(lifetime::singleton, &make_default<INTERFACE_T, T, internal::singleton_allocator<T>>);
+        }
+
+        template<typename INTERFACE_T, typename T, std::enable_if_t<(std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>) && !std::is_default_constructible_v<T>, bool> = true>
+        static void add()
+        {
+            type_registry::set_type<INTERFACE_T>();
+            bind<INTERFACE_T, T>(lifetime::singleton, &make_wired<INTERFACE_T, T, internal::singleton_allocator<T>>);
+        }
+
+        template<typename T>
+        static void add() { type_registry::set_type<T>(); add<T, T>(); }
+
+        // Registers T as the singleton bound to INTERFACE_T under KEY, resolved through
+        // di::get<INTERFACE_T, KEY>() or injected as cpp_di::keyed<INTERFACE_T, KEY>. Each key
+        // instantiates its own registry, independent of the unkeyed registration.
+        template<typename INTERFACE_T, typename T, fixed_string KEY, std::enable_if_t<std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>, bool> = true>
+        static void add()
+        {
+            bind<INTERFACE_T, T, internal::key_tag<KEY>>(lifetime::singleton, make_factory<INTERFACE_T, T, internal::singleton_allocator<T>>());
+        }
+
+        template<typename T, fixed_string KEY>
+        static void add() { add<T, T, KEY>(); }
+
+        // Registers INTERFACE_T so that every resolution, including injection into other
+        // constructors, builds a new T through std::allocate_shared with ALLOC_T. Instances
+        // injected as std::unique_ptr<INTERFACE_T> are deleted through INTERFACE_T*, so an
+        // interface distinct from T must have a virtual destructor.
+        template<typename INTERFACE_T, typename T, typename ALLOC_T = std::allocator<T>, std::enable_if_t<std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>, bool> = true>
+        static void add_transient()
+        {
+            static_assert(pointer_policy_t<INTERFACE_T>::allows_transient, "The pointer_policy of INTERFACE_T cannot hand out transient instances.");
+            static_assert(std::is_same_v<INTERFACE_T, T> || std::has_virtual_destructor_v<INTERFACE_T>, "Instances of T are deleted through INTERFACE_T*, which needs a virtual destructor.");
+            type_registry::set_type<INTERFACE_T>();
+            std::lock_guard lock(registration);
+            if (bind<INTERFACE_T, T>(lifetime::transient, make_factory<INTERFACE_T, T, ALLOC_T>()))
+            {
+                registry<INTERFACE_T>::owned_constructor = &make_owned<INTERFACE_T, T>;
+            }
+        }
+
+        template<typename T>
+        static void add_transient() { type_registry::set_type<T>(); add_transient<T, T>(); }
+
+        // Registers INTERFACE_T with one instance per di::scope. Resolving it outside of
+        // scope::get() throws std::logic_error.
+        template<typename INTERFACE_T, typename T, std::enable_if_t<std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>, bool> = true>
+        static void add_scoped()
+        {
+            static_assert(std::is_same_v<pointer_policy_t<INTERFACE_T>, shared_ownership>, "Scoped types require the shared_ownership policy.");
+            type_registry::set_type<INTERFACE_T>();
+            bind<INTERFACE_T, T>(lifetime::scoped, make_factory<INTERFACE_T, T, scope::allocator<T>>());
+        }
+
+        template<typename T>
+        static void add_scoped() { type_registry::set_type<T>(); add_scoped<T, T>(); }
+
+        // Registers INTERFACE_T with one instance per thread, for services that are not thread
+        // safe. Each thread builds its own on first resolution, wiring dependencies as usual, and
+        // destroys it on exit; the pointers it hands out must not be used past that point.
+        template<typename INTERFACE_T, typename T, std::enable_if_t<std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>, bool> = true>
+        static void add_per_thread()
+        {
+            type_registry::set_type<INTERFACE_T>();
+            bind<INTERFACE_T, T>(lifetime::per_thread, make_factory<INTERFACE_T, T, std::allocator<T>>());
+        }
+
+        template<typename T>
+        static void add_per_thread() { type_registry::set_type<T>(); add_per_thread<T, T>(); }
+
+        // Registers INTERFACE_T with one instance per NUMA node, for read-mostly singletons such
+        // as lookup tables: every thread resolves the replica of the node it runs on. Replicas are
+        // independent instances wired alike, so they must not carry state that has to be shared.
+        // Without NUMA support, or with a single node, this degenerates into a singleton.
+        template<typename INTERFACE_T, typename T, std::enable_if_t<std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>, bool> = true>
+        static void add_replicated()
+        {
+            type_registry::set_type<INTERFACE_T>();
+            std::lock_guard lock(registration);
+            if (bind<INTERFACE_T, T>(lifetime::replicated, make_factory<INTERFACE_T, T, std::allocator<T>>()))
+            {
+                registry<INTERFACE_T>::replicas = std::make_unique<typename registry<INTERFACE_T>::replica[]>(CPP_DI_MAX_NUMA_NODES);
+            }
+        }
+
+        template<typename T>
+        static void add_replicated() { type_registry::set_type<T>(); add_replicated<T, T>(); }
+
+        // Registers INTERFACE_T as pooled: di::acquire, or a cpp_di::pooled<INTERFACE_T>
+        // parameter, loans out an idle instance or builds a new one, and the handle gives it back
+        // when destroyed. reset, if given, runs on every instance given back. Instances are
+        // built with new, like those injected as std::unique_ptr, and must not be shared. The
+        // pool deletes them through INTERFACE_T*, which therefore needs a virtual destructor
+        // unless it is T.
+        template<typename INTERFACE_T, typename T, std::enable_if_t<std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>, bool> = true>
+        static void add_pooled(pool_options options = {}, void (*reset)(INTERFACE_T&) = nullptr)
+        {
+            static_assert(std::is_same_v<INTERFACE_T, T> || std::has_virtual_destructor_v<INTERFACE_T>, "Instances of T are deleted through INTERFACE_T*, which needs a virtual destructor.");
+            type_registry::set_type<INTERFACE_T>();
+            std::lock_guard lock(registration);
+            if (bind<INTERFACE_T, T>(lifetime::pooled, make_factory<INTERFACE_T, T, std::allocator<T>>()))
+            {
+                registry<INTERFACE_T>::owned_constructor = &make_owned<INTERFACE_T, T>;
+                pool<INTERFACE_T>::configure(options, reset);
+            }
+        }
+
+        template<typename T>
+        static void add_pooled(pool_options options = {}, void (*reset)(T&) = nullptr) { type_registry::set_type<T>(); add_pooled<T, T>(options, reset); }
+
+        // Runs the registrations of every module under one hold of the registration lock, so
+        // the whole set appears at once to registrations racing on other threads, e.g. from
+        // static initializers of several plugins. A module is a type with a static install()
+        // making di::add* calls, or a cpp_di::binding<INTERFACE_T, T> registered as a singleton.
+        // Registration must still be complete before the registered types are resolved.
+        template<typename... MODULES_T>
+        static void install()
+        {
+            std::lock_guard lock(registration);
+            (install_module<MODULES_T>(), ...);
+        }
+
+        template<typename T, typename... ARGS>
+        static factory<T, ARGS...> get_factory()
+        {
+            return assisted_factory(static_cast<factory<T, ARGS...>*>(nullptr));
+        }
+
+        template<typename T>
+        static pooled<T> acquire()
+        {
+            return pooled<T>(pool<T>::take(), &pool<T>::give);
+        }
+
+        // Wraps the registration of INTERFACE_T in DECORATOR_T, which receives the instance it
+        // decorates as its pointer_t<INTERFACE_T> constructor parameter and every other parameter
+        // through the usual wiring. Decorators compose in call order, the last one outermost, and
+        // keep the lifetime of the registration. The chain is a sequence of function pointers fixed
+        // at registration, so undecorated types are untouched. Must follow the registration of
+        // INTERFACE_T and precede its first resolution; std::unique_ptr injection of a transient
+        // still builds the undecorated implementation.
+        template<typename INTERFACE_T, typename DECORATOR_T>
+        static void decorate()
+        {
+            static_assert(std::is_base_of_v<INTERFACE_T, DECORATOR_T>, "DECORATOR_T must derive from INTERFACE_T.");
+            static_assert(pointer_policy_t<INTERFACE_T>::allows_transient, "The pointer_policy of INTERFACE_T cannot share the decorated instance.");
+
+            using registry_t = registry<INTERFACE_T>;
+            using decoration_t = decoration<INTERFACE_T, DECORATOR_T>;
+
+            std::lock_guard lock(registration);
+            if (!registry_t::constructor)
+            {
+                internal::raise(errc::not_registered, "Decorated interface is not registered.");
+            }
+            if (decoration_t::inner)
+            {
+                return;
+            }
+
+            decoration_t::inner = registry_t::constructor;
+            registry_t::constructor = &make_decorated<INTERFACE_T, DECORATOR_T>;
+
+            // The edge to the decorated instance is internal to the registration.
+            for (auto dependency : dependencies<DECORATOR_T>())
+            {
+                auto& edges = registry_t::info.dependencies;
+                if (dependency != &registry_t::info && std::find(edges.begin(), edges.end(), dependency) == edges.end())
+                {
+                    edges.push_back(dependency);
+                }
+            }
+        }
+
+        // Appends TS to the implementations injected as cpp_di::all<INTERFACE_T>. Each of TS is
+        // also registered as a singleton of its own type unless it already is. Extending the set
+        // after it was first resolved throws std::logic_error.
+        template<typename INTERFACE_T, typename... TS>
+        static void add_all()
+        {
+            static_assert((std::is_base_of_v<INTERFACE_T, TS> && ...), "Every implementation must derive from INTERFACE_T.");
+            static_assert(std::is_same_v<pointer_policy_t<INTERFACE_T>, shared_ownership> && (std::is_same_v<pointer_policy_t<TS>, shared_ownership> && ...),
+                "Multi-bindings require the shared_ownership policy.");
+            (type_registry::set_type<TS>(), ...);
+            std::lock_guard lock(registration);
+            (add<TS, TS>(), ...);
+            multi_registry<INTERFACE_T>::template bind<TS...>();
+        }
+
+        template<typename INTERFACE_T>
+        static all<INTERFACE_T> get_all()
+        {
+            return multi_registry<INTERFACE_T>::get();
+        }
+
+        template<typename T>
+        static pointer_t<T> get()
+        {
+            type_registry::check_type<T>();
+            return registry<T>::get();
+        }
+
+        template<typename T, fixed_string KEY>
+        static pointer_t<T> get()
+        {
+            return registry<T, internal::key_tag<KEY>>::get();
+        }
+
+        // Resolves like get(), but reports failures as an errc instead of throwing, including
+        // those of dependencies, which also works without exception support. There a user
+        // factory can only signal failure by yielding an empty pointer.
+        template<typename T>
+        static result<pointer_t<T>> try_get()
+        {
+            type_registry::check_type<T>();
+            return try_resolve<registry<T>>();
+        }
+
+        template<typename T, fixed_string KEY>
+        static result<pointer_t<T>> try_get()
+        {
+            return try_resolve<registry<T, internal::key_tag<KEY>>>();
+        }
+
+        // Called with every failure before the process aborts, when built without exceptions.
+        static void set_failure_handler(failure_handler handler)
+        {
+            internal::on_failure.store(handler, std::memory_order_release);
+        }
+
+        // Places every singleton built from now on, together with its control block, into one
+        // contiguous arena of capacity bytes, optionally backed by transparent huge pages. Must be
+        // called before the first singleton is constructed; once the arena is exhausted singletons
+        // fall back to the global heap. Returns false if an arena is already reserved or the
+        // memory cannot be obtained.
+        static bool use_singleton_arena(std::size_t capacity, bool huge_pages = false)
+        {
+            return internal::singleton_arena::reserve(capacity, huge_pages);
+        }
+
+        // Builds every registered singleton ahead of first use. Singletons whose dependencies are
+        // ready are handed to executor concurrently, in topological order of the graph discovered
+        // through refl::as_tuple. EXECUTOR_T is any callable accepting a nullary task, which may
+        // be run inline or on any thread. Rethrows the first construction failure.
+        template<typename EXECUTOR_T, std::enable_if_t<std::is_invocable_v<EXECUTOR_T&, schedule_task>, bool> = true>
+        static void warm_up(EXECUTOR_T&& executor)
+        {
+            std::unique_lock lock(registration);
+            schedule_state state(nodes, false);
+            lock.unlock();
+            state.action = [](internal::node* node, shutdown_mode) { node->warm(); };
+            schedule(state, executor);
+        }
+
+        static void warm_up(std::size_t threads = std::thread::hardware_concurrency())
+        {
+            schedule_pool pool(threads ? threads : 1);
+            warm_up(pool);
+        }
+
+        // Releases every singleton, and every replica of replicated registrations, in reverse
+        // topological order: a service goes only after all of its dependents, while independent
+        // subtrees are handed to executor concurrently. With shutdown_mode::fast_exit,
+        // trivially_disposable instances are leaked instead of destroyed. Instances still
+        // referenced elsewhere outlive their registry entry, and resolving a singleton afterwards
+        // yields an empty pointer.
+        template<typename EXECUTOR_T, std::enable_if_t<std::is_invocable_v<EXECUTOR_T&, schedule_task>, bool> = true>
+        static void shutdown(EXECUTOR_T&& executor, shutdown_mode mode = shutdown_mode::destroy)
+        {
+            std::unique_lock lock(registration);
+            schedule_state state(nodes, true);
+            lock.unlock();
+            state.mode = mode;
+            state.action = [](internal::node* node, shutdown_mode mode) { node->release(mode == shutdown_mode::fast_exit && node->disposable); };
+            schedule(state, executor);
+        }
+
+        static void shutdown(std::size_t threads, shutdown_mode mode = shutdown_mode::destroy)
+        {
+            schedule_pool pool(threads ? threads : 1);
+            shutdown(pool, mode);
+        }
+
+        static void shutdown(shutdown_mode mode = shutdown_mode::destroy)
+        {
+            shutdown([](schedule_task task) { task(); }, mode);
+        }
+
+        // Publishes replacement as the singleton of T. Readers switch to it without blocking;
+        // the previous instance is released once no get() can still be copying it and lives on
+        // only in the pointers already handed out. Pointers borrowed through get_ptr or get_ref,
+        // and instances injected into other singletons, keep referring to the previous object:
+        // borrows become dangling once it is released. T must be hot_swappable. With
+        // CPP_DI_SHARED_REGISTRY the replacement is seen by the calling module only.
+        template<typename T>
+        static void replace(storage_t<T> replacement)
+        {
+            static_assert(hot_swappable<T>::value, "T must be hot_swappable to be replaced.");
+            static_assert(pointer_policy_t<T>::allows_transient, "The pointer_policy of T cannot keep a replaced instance alive for its holders.");
+            registry<T>::publish(std::move(replacement));
+        }
+
+        // Builds a new instance through the registered factory, re-resolving its dependencies,
+        // and publishes it as with replace.
+        template<typename T>
+        static void rebuild()
+        {
+            static_assert(hot_swappable<T>::value, "T must be hot_swappable to be rebuilt.");
+            static_assert(pointer_policy_t<T>::allows_transient, "The pointer_policy of T cannot keep a replaced instance alive for its holders.");
+            registry<T>::publish(registry<T>::build());
+        }
+
+        // Snapshot of every registration in registration order with the dependency edges found
+        // through refl::as_tuple. Construction times are those of the registry's own instance,
+        // inclusive of the dependencies it had to build.
+        static std::vector<service_info> report()
+        {
+            std::lock_guard lock(registration);
+            std::unordered_map<internal::node*, std::size_t> index;
+            for (std::size_t i = 0; i < nodes.size(); i++)
+            {
+                index.emplace(nodes[i], i);
+            }
+
+            std::vector<service_info> result;
+            result.reserve(nodes.size());
+            for (auto node : nodes)
+            {
+                auto constructed = node->constructed();
+                service_info info{ node->name, node->key, node->kind, constructed, node->size, node->use_count(),
+                    constructed ? node->construction_time : std::chrono::nanoseconds{ 0 }, {} };
+                for (auto dependency : node->dependencies)
+                {
+                    if (auto it = index.find(dependency); it != index.end())
+                    {
+                        info.dependencies.push_back(it->second);
+                    }
+                }
+                result.push_back(std::move(info));
+            }
+            return result;
+        }
+
+        static void write_json(std::ostream& out)
+        {
+            constexpr const char* kinds[] = { "singleton", "transient", "scoped", "per_thread", "pooled", "replicated" };
+
+            out << "{\"services\":[";
+            bool first = true;
+            for (auto& service : report())
+            {
+                out << (first ? "" : ",") << "{\"name\":\"";
+                internal::write_escaped(out, service.name);
+                out << "\",\"key\":\"";
+                internal::write_escaped(out, service.key);
+                out << "\",\"lifetime\":\"" << kinds[static_cast<int>(service.kind)]
+                    << "\",\"constructed\":" << (service.constructed ? "true" : "false")
+                    << ",\"size\":" << service.size << ",\"use_count\":" << service.use_count
+                    << ",\"construction_us\":" << service.construction_time.count() / 1000.0 << ",\"dependencies\":[";
+                for (std::size_t i = 0; i < service.dependencies.size(); i++)
+                {
+                    out << (i ? "," : "") << service.dependencies[i];
+                }
+                out << "]}";
+                first = false;
+            }
+            out << "]}";
+        }
+
+        // Graphviz digraph with an edge from every service to each of its dependencies.
+        static void write_dot(std::ostream& out)
+        {
+            auto services = report();
+
+            out << "digraph cpp_di {\n";
+            for (std::size_t i = 0; i < services.size(); i++)
+            {
+                out << "  n" << i << " [label=\"";
+                internal::write_escaped(out, services[i].name);
+                if (!services[i].key.empty())
+                {
+                    out << " [";
+                    internal::write_escaped(out, services[i].key);
+                    out << ']';
+                }
+                out << "\\n" << services[i].size << " B, use_count " << services[i].use_count << "\"";
+                if (!services[i].constructed)
+                {
+                    out << " style=dashed";
+                }
+                out << "];\n";
+            }
+            for (std::size_t i = 0; i < services.size(); i++)
+            {
+                for (auto dependency : services[i].dependencies)
+                {
+                    out << "  n" << i << " -> n" << dependency << ";\n";
+                }
+            }
+            out << "}\n";
+        }
+
+        // Resolves T without blocking the caller. All dependencies discovered through
+        // refl::as_tuple are started concurrently before T itself is built, so a graph of
+        // I/O-bound constructors costs its longest path rather than the sum of its nodes.
+        // Construction failures are reported through the future.
+        template<typename T>
+        static std::shared_future<pointer_t<T>> get_async()
+        {
+            type_registry::check_type<T>();
+            auto ready = internal::warm_async(&registry<T>::info);
+            return std::async(std::launch::deferred, [ready]()
+            {
+                ready.get();
+                return registry<T>::get();
+            }).share();
+        }
+
+        // Builds a new instance regardless of the registered lifetime.
+        template<typename T>
+        static storage_t<T> create()
+        {
+            type_registry::check_type<T>();
+            return registry<T>::build();
+        }
+
+        template<typename T>
+        static T* get_ptr()
+        {
+            type_registry::check_type<T>();
+            return registry<T>::get_ptr();
+        }
+
+        template<typename T>
+        static T& get_ref()
+        {
+            type_registry::check_type<T>();
+            return *registry<T>::get_ptr();
+        }
+    };
+
+    // Entry of a static_container mapping INTERFACE_T onto the concrete type T.
+    template<typename INTERFACE_T, typename T = INTERFACE_T>
+    struct binding
+    {
+        static_assert(std::is_same_v<INTERFACE_T, T> || std::is_base_of_v<INTERFACE_T, T>, "binding<INTERFACE_T, T> requires T to derive from INTERFACE_T.");
+
+        using interface_type = INTERFACE_T;
+        using type = T;
+    };
+
+    namespace internal
+    {
+        template<typename... Ts> struct type_list {};
+
+        template<typename T, typename LIST> struct contains;
+        template<typename T, typename... Ts>
+        struct contains<T, type_list<Ts...>> : std::bool_constant<(std::is_same_v<T, Ts> || ...)> {};
+
+        template<typename LIST, typename T> struct append;
+        template<typename... Ts, typename T>
+        struct append<type_list<Ts...>, T> { using type = type_list<Ts..., T>; };
+
+        template<typename LIST, typename RESULT = type_list<>> struct reverse { using type = RESULT; };
+        template<typename T, typename... Ts, typename... Rs>
+        struct reverse<type_list<T, Ts...>, type_list<Rs...>> : reverse<type_list<Ts...>, type_list<T, Rs...>> {};
+
+        template<typename T> struct as_binding { using type = binding<T>; };
+        template<typename INTERFACE_T, typename T> struct as_binding<binding<INTERFACE_T, T>> { using type = binding<INTERFACE_T, T>; };
+
+        // Instantiated to fail compilation; the template arguments spell out the offending path.
+        template<typename... PATH>
+        struct dependency_cycle
+        {
+            static_assert(sizeof...(PATH) == 0, "Dependency cycle in static_container, see the dependency_cycle<...> template arguments.");
+        };
+
+        template<typename INTERFACE_T>
+        struct missing_binding
+        {
+            static_assert(sizeof(INTERFACE_T*) == 0, "static_container has no binding for INTERFACE_T.");
+        };
+
+        template<typename CLASS_T, typename ARGUMENT_T>
+        struct unsupported_argument
+        {
+            static_assert(sizeof(CLASS_T*) == 0, "Constructor for class CLASS_T argument type ARGUMENT_T should be std::shared_ptr.");
+        };
+
+        template<typename INTERFACE_T, typename... BINDINGS> struct find_binding { using type = void; };
+        template<typename INTERFACE_T, typename BINDING_T, typename... BINDINGS>
+        struct find_binding<INTERFACE_T, BINDING_T, BINDINGS...>
+            : std::conditional_t<std::is_same_v<typename BINDING_T::interface_type, INTERFACE_T>, std::type_identity<BINDING_T>, find_binding<INTERFACE_T, BINDINGS...>> {};
+
+        template<typename CLASS_T, typename ARGUMENT_T>
+        struct dependency_of
+        {
+            using type = typename unsupported_argument<CLASS_T, ARGUMENT_T>::type;
+        };
+        template<typename CLASS_T, typename T>
+        struct dependency_of<CLASS_T, std::shared_ptr<T>> { using type = T; };
+
+        template<typename T, typename TUPLE_T> struct dependency_list_impl;
+        template<typename T, typename... ARGS>
+        struct dependency_list_impl<T, std::tuple<ARGS...>> { using type = type_list<typename dependency_of<T, ARGS>::type...>; };
+
+        // Interfaces T gets injected with, following the same rules as di::add.
+        template<typename T, bool = std::is_default_constructible_v<T>>
+        struct dependency_list { using type = type_list<>; };
+        template<typename T>
+        struct dependency_list<T, false> { using type = typename dependency_list_impl<T, constructor_args_t<T>>::type; };
+
+        template<typename BINDINGS, typename DONE, typename PATH, typename INTERFACE_T, typename = void>
+        struct visit;
+
+        template<typename BINDINGS, typename DONE, typename PATH, typename DEPENDENCIES>
+        struct visit_all { using type = DONE; };
+        template<typename BINDINGS, typename DONE, typename PATH, typename D, typename... Ds>
+        struct visit_all<BINDINGS, DONE, PATH, type_list<D, Ds...>>
+        {
+            using type = typename visit_all<BINDINGS, typename visit<BINDINGS, DONE, PATH, D>::type, PATH, type_list<Ds...>>::type;
+        };
+
+        template<typename... BINDINGS, typename DONE, typename... PATH, typename INTERFACE_T>
+        struct visit<type_list<BINDINGS...>, DONE, type_list<PATH...>, INTERFACE_T, std::enable_if_t<contains<INTERFACE_T, DONE>::value>>
+        {
+            using type = DONE;
+        };
+
+        // Depth-first post-order walk: DONE accumulates interfaces in construction order.
+        template<typename... BINDINGS, typename DONE, typename... PATH, typename INTERFACE_T>
+        struct visit<type_list<BINDINGS...>, DONE, type_list<PATH...>, INTERFACE_T, std::enable_if_t<!contains<INTERFACE_T, DONE>::value>>
+        {
+            static auto walk()
+            {
+                using binding_t = typename find_binding<INTERFACE_T, BINDINGS...>::type;
+
+                if constexpr (contains<INTERFACE_T, type_list<PATH...>>::value)
+                {
+                    sizeof(dependency_cycle<PATH..., INTERFACE_T>);
+                    return std::type_identity<DONE>{};
+                }
+                else if constexpr (std::is_void_v<binding_t>)
+                {
+                    sizeof(missing_binding<INTERFACE_T>);
+                    return std::type_identity<DONE>{};
+                }
+                else
+                {
+                    using dependencies = typename dependency_list<typename binding_t::type>::type;
+                    using visited = typename visit_all<type_list<BINDINGS...>, DONE, type_list<PATH..., INTERFACE_T>, dependencies>::type;
+                    return std::type_identity<typename append<visited, INTERFACE_T>::type>{};
+                }
+            }
+
+            using type = typename decltype(walk())::type;
+        };
+
+        template<typename T, typename... Ts>
+        constexpr std::size_t count_of()
+        {
+            return (std::size_t{ 0 } + ... + std::size_t{ std::is_same_v<T, Ts> });
+        }
+
+        template<typename INTERFACE_T, typename... Ts>
+        constexpr std::size_t index_of()
+        {
+            constexpr bool matches[] = { std::is_same_v<INTERFACE_T, Ts>... };
+            for (std::size_t i = 0; i < sizeof...(Ts); i++)
+            {
+                if (matches[i])
+                {
+                    return i;
+                }
+            }
+            return sizeof...(Ts);
+        }
+    }
+
+    // Container whose whole graph is described by its template arguments: concrete types or
+    // binding<INTERFACE_T, T>. Dependencies, missing bindings and cycles are checked at compile
+    // time, and the constructor is a straight-line sequence building every entry in topological
+    // order, with no registry, call_once or factory indirection involved. All entries are
+    // singletons of the container and are destroyed in reverse construction order.
+    template<typename... ENTRIES>
+    class static_container
+    {
+        using bindings = internal::type_list<typename internal::as_binding<ENTRIES>::type...>;
+
+        template<typename INTERFACE_T>
+        using concrete_t = typename internal::find_binding<INTERFACE_T, typename internal::as_binding<ENTRIES>::type...>::type::type;
+
+        template<typename INTERFACE_T>
+        static constexpr std::size_t index = internal::index_of<INTERFACE_T, typename internal::as_binding<ENTRIES>::type::interface_type...>();
+
+        using order = typename internal::visit_all<bindings, internal::type_list<>, internal::type_list<>,
+            internal::type_list<typename internal::as_binding<ENTRIES>::type::interface_type...>>::type;
+
+        static_assert(((internal::count_of<typename internal::as_binding<ENTRIES>::type::interface_type, typename internal::as_binding<ENTRIES>::type::interface_type...>() == 1) && ...),
+            "static_container binds the same interface more than once.");
+
+        std::tuple<std::shared_ptr<typename internal::as_binding<ENTRIES>::type::interface_type>...> instances;
+
+        template<typename T, typename... DEPENDENCIES>
+        std::shared_ptr<T> make(internal::type_list<DEPENDENCIES...>)
+        {
+            return std::make_shared<T>(std::get<index<DEPENDENCIES>>(instances)...);
+        }
+
+        template<typename... INTERFACES>
+        void build(internal::type_list<INTERFACES...>)
+        {
+            ((std::get<index<INTERFACES>>(instances) = make<concrete_t<INTERFACES>>(typename internal::dependency_list<concrete_t<INTERFACES>>::type{})), ...);
+        }
+
+        template<typename... INTERFACES>
+        void destroy(internal::type_list<INTERFACES...>)
+        {
+            (std::get<index<INTERFACES>>(instances).reset(), ...);
+        }
+    public:
+        static_container()
+        {
+            build(order{});
+        }
+
+        ~static_container()
+        {
+            destroy(typename internal::reverse<order>::type{});
+        }
+
+        static_container(const static_container&) = delete;
+        static_container& operator=(const static_container&) = delete;
+
+        template<typename INTERFACE_T>
+        const std::shared_ptr<INTERFACE_T>& get() const
+        {
+            static_assert(index<INTERFACE_T> < sizeof...(ENTRIES), "static_container has no binding for INTERFACE_T.");
+            return std::get<index<INTERFACE_T>>(instances);
         }
     };
 }
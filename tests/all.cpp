@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <string_view>
+
+using namespace cpp_di;
+
+namespace
+{
+    // Every test binds its own interface, N, since a resolved multi-binding cannot be extended.
+    template<int N>
+    struct plugin
+    {
+        virtual ~plugin() = default;
+        virtual std::string_view name() const = 0;
+    };
+
+    template<int N>
+    struct alpha : plugin<N>
+    {
+        std::string_view name() const override { return "alpha"; }
+    };
+
+    template<int N>
+    struct beta : plugin<N>
+    {
+        std::string_view name() const override { return "beta"; }
+    };
+
+    template<int N>
+    struct gamma : plugin<N>
+    {
+        std::string_view name() const override { return "gamma"; }
+    };
+
+    struct host
+    {
+        all<plugin<2>> plugins;
+
+        host(all<plugin<2>> plugins) : plugins(std::move(plugins)) {}
+    };
+}
+
+TEST(all, resolves_in_registration_order)
+{
+    di::add_all<plugin<0>, alpha<0>, beta<0>>();
+    di::add_all<plugin<0>, gamma<0>>();
+
+    auto plugins = di::get_all<plugin<0>>();
+    ASSERT_EQ(plugins.size(), 3u);
+    EXPECT_EQ(plugins[0]->name(), "alpha");
+    EXPECT_EQ(plugins[1]->name(), "beta");
+    EXPECT_EQ(plugins[2]->name(), "gamma");
+
+    int visited = 0;
+    for (const auto& p : plugins)
+    {
+        EXPECT_TRUE(p);
+        visited++;
+    }
+    EXPECT_EQ(visited, 3);
+}
+
+TEST(all, implementations_are_singletons_of_their_own_type)
+{
+    // add_all registers them from a template, so di::get needs the types seen here.
+    type_registry::set_type<alpha<1>>();
+    di::add_all<plugin<1>, alpha<1>, beta<1>>();
+
+    auto plugins = di::get_all<plugin<1>>();
+    ASSERT_EQ(plugins.size(), 2u);
+    EXPECT_EQ(plugins[0].get(), static_cast<plugin<1>*>(di::get<alpha<1>>().get()));
+    EXPECT_EQ(di::get_all<plugin<1>>().begin(), plugins.begin());
+}
+
+TEST(all, injects_every_implementation)
+{
+    di::add_all<plugin<2>, alpha<2>, beta<2>>();
+    di::add<host>();
+
+    auto h = di::get<host>();
+    ASSERT_EQ(h->plugins.size(), 2u);
+    EXPECT_EQ(h->plugins[1], di::get_all<plugin<2>>()[1]);
+}
+
+TEST(all, an_unbound_interface_resolves_empty)
+{
+    EXPECT_TRUE(di::get_all<plugin<3>>().empty());
+}
+
+TEST(all, extending_after_resolution_raises)
+{
+    di::add_all<plugin<4>, alpha<4>>();
+    di::get_all<plugin<4>>();
+
+    try
+    {
+        di::add_all<plugin<4>, beta<4>>();
+        FAIL() << "a resolved multi-binding was extended";
+    }
+    catch (const error& e)
+    {
+        EXPECT_EQ(e.code(), errc::already_resolved);
+    }
+    EXPECT_EQ(di::get_all<plugin<4>>().size(), 1u);
+}
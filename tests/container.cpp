@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <memory>
+
+using namespace cpp_di;
+
+namespace
+{
+    struct timer { int ticks = 0; };
+
+    struct scheduler
+    {
+        std::shared_ptr<timer> time;
+
+        scheduler(std::shared_ptr<timer> time) : time(std::move(time)) {}
+    };
+
+    struct job
+    {
+        std::shared_ptr<timer> time;
+
+        job(std::shared_ptr<timer> time) : time(std::move(time)) {}
+    };
+
+    struct worker
+    {
+        std::unique_ptr<job> task;
+
+        worker(std::unique_ptr<job> task) : task(std::move(task)) {}
+    };
+
+    struct absent {};
+}
+
+TEST(container, resolves_one_instance_per_container)
+{
+    di::container c;
+    c.add<timer>();
+
+    auto first = c.get<timer>();
+    EXPECT_EQ(first, c.get<timer>());
+    EXPECT_EQ(first.get(), c.get_ptr<timer>());
+    EXPECT_EQ(first.get(), &c.get_ref<timer>());
+}
+
+TEST(container, wires_dependencies_from_the_same_container)
+{
+    di::container c;
+    c.add<timer>();
+    c.add<scheduler>();
+
+    EXPECT_EQ(c.get<scheduler>()->time, c.get<timer>());
+}
+
+TEST(container, containers_are_independent)
+{
+    di::container first;
+    di::container second;
+    first.add<timer>();
+    second.add<timer>();
+    first.get_ref<timer>().ticks = 3;
+
+    EXPECT_NE(first.get<timer>(), second.get<timer>());
+    EXPECT_EQ(second.get<timer>()->ticks, 0);
+}
+
+TEST(container, transients_are_built_on_every_resolution)
+{
+    di::container c;
+    c.add<timer>();
+    c.add_transient<job>();
+    c.add<worker>();
+
+    auto first = c.get<job>();
+    EXPECT_NE(first, c.get<job>());
+    EXPECT_EQ(first->time, c.get<timer>());
+
+    auto w = c.get<worker>();
+    ASSERT_TRUE(w->task);
+    EXPECT_EQ(w->task->time, c.get<timer>());
+}
+
+TEST(container, instances_live_as_long_as_the_container)
+{
+    std::weak_ptr<timer> watch;
+    {
+        di::container c;
+        c.add<timer>();
+        watch = c.get<timer>();
+        EXPECT_FALSE(watch.expired());
+    }
+    EXPECT_TRUE(watch.expired());
+}
+
+TEST(container, reports_unregistered_types_and_borrowed_transients)
+{
+    di::container c;
+    c.add_transient<timer>();
+
+    try
+    {
+        c.get<absent>();
+        FAIL() << "get<absent>() returned";
+    }
+    catch (const error& e)
+    {
+        EXPECT_EQ(e.code(), errc::not_registered);
+    }
+
+    try
+    {
+        c.get_ptr<timer>();
+        FAIL() << "a transient was borrowed";
+    }
+    catch (const error& e)
+    {
+        EXPECT_EQ(e.code(), errc::wrong_lifetime);
+    }
+}
+
+// Registrations of a container do not touch the global registry.
+TEST(container, leaves_the_global_registry_alone)
+{
+    // Made known to the global registry without registering it there.
+    type_registry::set_type<absent>();
+
+    di::container c;
+    c.add<absent>();
+    c.get<absent>();
+
+    EXPECT_EQ(di::try_get<absent>().error(), errc::not_registered);
+}
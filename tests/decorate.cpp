@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <memory>
+#include <string>
+
+using namespace cpp_di;
+
+namespace
+{
+    // Every test decorates its own interface, N.
+    template<int N>
+    struct store
+    {
+        virtual ~store() = default;
+        virtual std::string describe() const = 0;
+    };
+
+    template<int N>
+    struct memory_store : store<N>
+    {
+        std::string describe() const override { return "memory"; }
+    };
+
+    struct journal { int entries = 0; };
+
+    // Its inner instance arrives as a shared_ptr<store<N>>, next to a wired dependency.
+    template<int N>
+    struct logging : store<N>
+    {
+        std::shared_ptr<store<N>> inner;
+        std::shared_ptr<journal> log;
+
+        logging(std::shared_ptr<store<N>> inner, std::shared_ptr<journal> log)
+            : inner(std::move(inner)), log(std::move(log))
+        {
+        }
+
+        std::string describe() const override { return "logging(" + inner->describe() + ")"; }
+    };
+
+    template<int N>
+    struct caching : store<N>
+    {
+        std::shared_ptr<store<N>> inner;
+
+        caching(std::shared_ptr<store<N>> inner) : inner(std::move(inner)) {}
+
+        std::string describe() const override { return "caching(" + inner->describe() + ")"; }
+    };
+
+    const bool registered = []
+    {
+        di::add<journal>();
+        return true;
+    }();
+}
+
+TEST(decorate, wraps_the_registration)
+{
+    ASSERT_TRUE(registered);
+
+    di::add<store<0>, memory_store<0>>();
+    di::decorate<store<0>, logging<0>>();
+
+    auto s = di::get<store<0>>();
+    EXPECT_EQ(s->describe(), "logging(memory)");
+    EXPECT_EQ(static_cast<logging<0>*>(s.get())->log, di::get<journal>());
+}
+
+TEST(decorate, the_last_decorator_is_outermost)
+{
+    di::add<store<1>, memory_store<1>>();
+    di::decorate<store<1>, logging<1>>();
+    di::decorate<store<1>, caching<1>>();
+
+    EXPECT_EQ(di::get<store<1>>()->describe(), "caching(logging(memory))");
+}
+
+TEST(decorate, keeps_the_singleton_lifetime)
+{
+    di::add<store<2>, memory_store<2>>();
+    di::decorate<store<2>, caching<2>>();
+
+    EXPECT_EQ(di::get<store<2>>(), di::get<store<2>>());
+}
+
+TEST(decorate, keeps_the_transient_lifetime)
+{
+    di::add_transient<store<3>, memory_store<3>>();
+    di::decorate<store<3>, caching<3>>();
+
+    auto first = di::get<store<3>>();
+    auto second = di::get<store<3>>();
+    EXPECT_NE(first, second);
+    EXPECT_NE(static_cast<caching<3>*>(first.get())->inner, static_cast<caching<3>*>(second.get())->inner);
+    EXPECT_EQ(second->describe(), "caching(memory)");
+}
+
+TEST(decorate, an_unregistered_interface_raises)
+{
+    try
+    {
+        di::decorate<store<4>, caching<4>>();
+        FAIL() << "an unregistered interface was decorated";
+    }
+    catch (const error& e)
+    {
+        EXPECT_EQ(e.code(), errc::not_registered);
+    }
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <memory>
+#include <string>
+
+using namespace cpp_di;
+
+namespace
+{
+    struct logger { int lines = 0; };
+
+    // Neither is registered: factories build them from their constructor_args.
+    struct connection
+    {
+        int fd;
+        std::shared_ptr<logger> log;
+
+        connection(int fd, std::shared_ptr<logger> log) : fd(fd), log(std::move(log)) {}
+    };
+
+    struct message
+    {
+        using inject = std::tuple<std::string&&, std::shared_ptr<logger>>;
+
+        std::string text;
+        std::shared_ptr<logger> log;
+
+        message(std::string&& text, std::shared_ptr<logger> log) : text(std::move(text)), log(std::move(log)) {}
+    };
+
+    struct acceptor
+    {
+        factory<connection, int> open;
+
+        acceptor(factory<connection, int> open) : open(open) {}
+    };
+
+    const bool registered = []
+    {
+        di::add<logger>();
+        di::add<acceptor>();
+        return true;
+    }();
+}
+
+TEST(factory, mixes_runtime_arguments_with_wired_dependencies)
+{
+    ASSERT_TRUE(registered);
+
+    auto open = di::get_factory<connection, int>();
+    auto c = open(7);
+    ASSERT_TRUE(c);
+    EXPECT_EQ(c->fd, 7);
+    EXPECT_EQ(c->log, di::get<logger>());
+}
+
+TEST(factory, builds_a_new_instance_on_every_call)
+{
+    auto open = di::get_factory<connection, int>();
+
+    auto first = open(1);
+    auto second = open(2);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(second->fd, 2);
+    EXPECT_EQ(first->log, second->log);
+}
+
+TEST(factory, is_injected_as_a_constructor_parameter)
+{
+    auto a = di::get<acceptor>();
+
+    auto c = a->open(3);
+    EXPECT_EQ(c->fd, 3);
+    EXPECT_EQ(c->log, di::get<logger>());
+}
+
+TEST(factory, forwards_rvalue_arguments)
+{
+    auto make = di::get_factory<message, std::string&&>();
+
+    std::string text(64, 'x');
+    auto m = make(std::move(text));
+    EXPECT_EQ(m->text, std::string(64, 'x'));
+    EXPECT_TRUE(text.empty());
+    EXPECT_EQ(m->log, di::get<logger>());
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <atomic>
+#include <memory>
+
+using namespace cpp_di;
+
+namespace
+{
+    template<int N>
+    struct leaf
+    {
+        inline static std::atomic<int> built{ 0 };
+
+        leaf()
+        {
+            built.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    template<int N>
+    struct root
+    {
+        std::shared_ptr<leaf<N>> left;
+        std::shared_ptr<leaf<N + 1>> right;
+
+        root(std::shared_ptr<leaf<N>> left, std::shared_ptr<leaf<N + 1>> right)
+            : left(std::move(left)), right(std::move(right))
+        {
+        }
+    };
+
+    struct missing {};
+
+    struct needs_missing
+    {
+        std::shared_ptr<missing> dependency;
+
+        needs_missing(std::shared_ptr<missing> dependency) : dependency(std::move(dependency)) {}
+    };
+}
+
+TEST(get_async, builds_every_dependency_once)
+{
+    di::add<leaf<0>>();
+    di::add<leaf<1>>();
+    di::add<root<0>>();
+
+    auto first = di::get_async<root<0>>();
+    auto second = di::get_async<root<0>>();
+
+    auto built = first.get();
+    ASSERT_TRUE(built);
+    EXPECT_EQ(built, second.get());
+    EXPECT_EQ(built->left, di::get<leaf<0>>());
+    EXPECT_EQ(leaf<0>::built.load(), 1);
+    EXPECT_EQ(leaf<1>::built.load(), 1);
+}
+
+// A failed attempt is not remembered: once the dependency exists, get_async succeeds like get().
+TEST(get_async, failures_are_retried)
+{
+    di::add<needs_missing>();
+
+    try
+    {
+        di::get_async<needs_missing>().get();
+        FAIL() << "get_async succeeded without its dependency";
+    }
+    catch (const error& e)
+    {
+        EXPECT_EQ(e.code(), errc::not_registered);
+    }
+
+    di::add<missing>();
+    auto resolved = di::get_async<needs_missing>().get();
+    ASSERT_TRUE(resolved);
+    EXPECT_EQ(resolved, di::get<needs_missing>());
+}
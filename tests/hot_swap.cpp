@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace cpp_di;
+
+namespace
+{
+    // Counts its live instances and how many the registered factory built.
+    template<int N>
+    struct setting
+    {
+        static constexpr bool hot_swappable = true;
+
+        inline static std::atomic<int> alive{ 0 };
+        inline static std::atomic<int> built{ 0 };
+
+        int value;
+
+        setting() : value(0)
+        {
+            built.fetch_add(1, std::memory_order_relaxed);
+            alive.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        explicit setting(int value) : value(value)
+        {
+            alive.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ~setting()
+        {
+            alive.fetch_sub(1, std::memory_order_relaxed);
+        }
+    };
+
+    using early = setting<0>;
+    using swapped = setting<1>;
+    using rebuilt = setting<2>;
+    using raced = setting<3>;
+    using restarted = setting<4>;
+}
+
+// A replacement published before the first get() wins over the factory, which never runs.
+TEST(hot_swap, replace_before_first_use)
+{
+    di::add<early>();
+    di::replace<early>(std::make_shared<early>(42));
+
+    EXPECT_EQ(di::get<early>()->value, 42);
+    EXPECT_EQ(di::get_ptr<early>()->value, 42);
+    EXPECT_EQ(early::built.load(), 0);
+    EXPECT_EQ(early::alive.load(), 1);
+}
+
+TEST(hot_swap, replace_after_use_releases_the_previous_instance)
+{
+    di::add<swapped>();
+    auto previous = di::get<swapped>();
+    std::weak_ptr<swapped> watch = previous;
+
+    di::replace<swapped>(std::make_shared<swapped>(7));
+
+    EXPECT_EQ(di::get<swapped>()->value, 7);
+    EXPECT_EQ(previous->value, 0);
+
+    previous.reset();
+    EXPECT_TRUE(watch.expired());
+    EXPECT_EQ(swapped::alive.load(), 1);
+}
+
+TEST(hot_swap, rebuild_runs_the_factory_again)
+{
+    di::add<rebuilt>();
+    auto first = di::get<rebuilt>();
+
+    di::rebuild<rebuilt>();
+
+    EXPECT_NE(di::get<rebuilt>(), first);
+    EXPECT_EQ(rebuilt::built.load(), 2);
+}
+
+// After shutdown the registry holds no instance; replacing or rebuilding afterwards publishes
+// a new one.
+TEST(hot_swap, replace_and_rebuild_after_shutdown)
+{
+    di::add<restarted>();
+    di::get<restarted>();
+
+    di::shutdown();
+    EXPECT_FALSE(di::get<restarted>());
+    EXPECT_EQ(restarted::alive.load(), 0);
+
+    di::replace<restarted>(std::make_shared<restarted>(5));
+    EXPECT_EQ(di::get<restarted>()->value, 5);
+
+    di::rebuild<restarted>();
+    EXPECT_EQ(di::get<restarted>()->value, 0);
+    EXPECT_EQ(restarted::built.load(), 2);
+    EXPECT_EQ(restarted::alive.load(), 1);
+}
+
+// Readers only ever see instances that are alive and never go back to an older one while
+// the writer keeps replacing; every retired instance is released by the end.
+TEST(hot_swap, readers_see_monotonic_replacements)
+{
+    constexpr int replacements = 2000;
+    constexpr int readers = 8;
+
+    di::add<raced>();
+    di::get<raced>();
+
+    std::atomic<bool> done{ false };
+    std::atomic<int> regressions{ 0 };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < readers; i++)
+    {
+        threads.emplace_back([&]()
+        {
+            int last = 0;
+            while (!done.load(std::memory_order_acquire))
+            {
+                auto current = di::get<raced>();
+                if (current->value < last)
+                {
+                    regressions.fetch_add(1, std::memory_order_relaxed);
+                }
+                last = current->value;
+            }
+        });
+    }
+
+    for (int i = 1; i <= replacements; i++)
+    {
+        di::replace<raced>(std::make_shared<raced>(i));
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(regressions.load(), 0);
+    EXPECT_EQ(di::get<raced>()->value, replacements);
+    EXPECT_EQ(raced::alive.load(), 1);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <memory>
+#include <string_view>
+
+using namespace cpp_di;
+
+namespace
+{
+    struct endpoint
+    {
+        virtual ~endpoint() = default;
+        virtual std::string_view host() const = 0;
+    };
+
+    struct primary : endpoint
+    {
+        std::string_view host() const override { return "primary"; }
+    };
+
+    struct replica : endpoint
+    {
+        std::string_view host() const override { return "replica"; }
+    };
+
+    struct fallback : endpoint
+    {
+        std::string_view host() const override { return "fallback"; }
+    };
+
+    struct router
+    {
+        keyed<endpoint, "primary"> writes;
+        keyed<endpoint, "replica"> reads;
+
+        router(keyed<endpoint, "primary"> writes, keyed<endpoint, "replica"> reads)
+            : writes(std::move(writes)), reads(std::move(reads))
+        {
+        }
+    };
+
+    struct setting { int value = 0; };
+
+    const bool registered = []
+    {
+        di::add<endpoint, primary, "primary">();
+        di::add<endpoint, replica, "replica">();
+        di::add<endpoint, fallback>();
+        di::add<router>();
+        di::add<setting, "a">();
+        di::add<setting, "b">();
+        return true;
+    }();
+}
+
+TEST(keyed, each_key_resolves_its_own_registration)
+{
+    ASSERT_TRUE(registered);
+
+    auto w = di::get<endpoint, "primary">();
+    auto r = di::get<endpoint, "replica">();
+    EXPECT_EQ(w->host(), "primary");
+    EXPECT_EQ(r->host(), "replica");
+    EXPECT_EQ(w, (di::get<endpoint, "primary">()));
+}
+
+TEST(keyed, keys_are_independent_of_the_unkeyed_registration)
+{
+    EXPECT_EQ(di::get<endpoint>()->host(), "fallback");
+    EXPECT_NE(di::get<endpoint>(), (di::get<endpoint, "primary">()));
+}
+
+TEST(keyed, same_type_under_several_keys)
+{
+    di::get<setting, "a">()->value = 1;
+
+    EXPECT_EQ((di::get<setting, "b">()->value), 0);
+    EXPECT_NE((di::get<setting, "a">()), (di::get<setting, "b">()));
+}
+
+TEST(keyed, injects_keyed_parameters)
+{
+    auto r = di::get<router>();
+    EXPECT_EQ(r->writes->host(), "primary");
+    EXPECT_EQ(r->reads.get(), (di::get<endpoint, "replica">().get()));
+    EXPECT_EQ((keyed<endpoint, "replica">::key), "replica");
+}
+
+TEST(keyed, reports_an_unregistered_key)
+{
+    auto r = di::try_get<endpoint, "archive">();
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.error(), errc::not_registered);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <atomic>
+#include <memory>
+
+using namespace cpp_di;
+
+namespace
+{
+    // Counts how many instances were built.
+    template<int N>
+    struct expensive
+    {
+        inline static std::atomic<int> built{ 0 };
+
+        expensive() { built.fetch_add(1, std::memory_order_relaxed); }
+    };
+
+    template<int N>
+    struct owner
+    {
+        lazy<expensive<N>> dependency;
+
+        owner(lazy<expensive<N>> dependency) : dependency(std::move(dependency)) {}
+    };
+
+    struct session { int id = 0; };
+
+    struct page
+    {
+        lazy<session> current;
+
+        page(lazy<session> current) : current(std::move(current)) {}
+    };
+
+    const bool registered = []
+    {
+        di::add<expensive<0>>();
+        di::add<owner<0>>();
+        di::add_scoped<session>();
+        di::add_transient<page>();
+        return true;
+    }();
+}
+
+TEST(lazy, resolves_on_first_dereference)
+{
+    ASSERT_TRUE(registered);
+
+    auto o = di::get<owner<0>>();
+    EXPECT_FALSE(o->dependency.resolved());
+    EXPECT_EQ(expensive<0>::built.load(), 0);
+
+    auto ptr = o->dependency.get();
+    EXPECT_TRUE(o->dependency.resolved());
+    EXPECT_EQ(expensive<0>::built.load(), 1);
+    EXPECT_EQ(ptr, di::get<expensive<0>>().get());
+    EXPECT_EQ(o->dependency.shared(), di::get<expensive<0>>());
+    EXPECT_EQ(expensive<0>::built.load(), 1);
+}
+
+TEST(lazy, resolves_in_the_container_of_its_owner)
+{
+    // Without a container, lazy falls back to the global registry, which has to know the type.
+    type_registry::set_type<expensive<1>>();
+
+    di::container c;
+    c.add<expensive<1>>();
+    c.add<owner<1>>();
+
+    auto o = c.get<owner<1>>();
+    EXPECT_EQ(expensive<1>::built.load(), 0);
+    EXPECT_EQ(o->dependency.get(), c.get_ptr<expensive<1>>());
+    EXPECT_EQ(expensive<1>::built.load(), 1);
+}
+
+TEST(lazy, resolves_in_the_scope_of_its_owner)
+{
+    di::scope s;
+
+    auto p = s.get<page>();
+    EXPECT_FALSE(p->current.resolved());
+    EXPECT_EQ(p->current.get(), s.get<session>().get());
+}
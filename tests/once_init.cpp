@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace cpp_di;
+
+namespace
+{
+    constexpr std::size_t threads = 64;
+
+    struct slow
+    {
+        inline static std::atomic<int> constructions{ 0 };
+
+        slow()
+        {
+            constructions.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    };
+
+    struct flaky
+    {
+        inline static std::atomic<int> attempts{ 0 };
+
+        flaky()
+        {
+            if (attempts.fetch_add(1, std::memory_order_relaxed) == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                throw std::runtime_error("first construction fails");
+            }
+        }
+    };
+
+    // Starts every thread on the same latch so that they reach the cold registry together.
+    template<typename FUNCTION_T>
+    void race(FUNCTION_T&& function)
+    {
+        std::latch start(threads);
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i < threads; i++)
+        {
+            workers.emplace_back([&, i]()
+            {
+                start.arrive_and_wait();
+                function(i);
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+}
+
+TEST(once_init, cold_singleton_is_constructed_once_under_contention)
+{
+    di::add<slow>();
+
+    std::vector<slow*> seen(threads);
+    race([&](std::size_t i) { seen[i] = di::get_ptr<slow>(); });
+
+    EXPECT_EQ(slow::constructions.load(), 1);
+    for (auto ptr : seen)
+    {
+        EXPECT_EQ(ptr, seen.front());
+    }
+}
+
+// The thread whose construction throws sees the exception; the waiters parked behind it are
+// woken, one of them constructs again and the rest share its instance.
+TEST(once_init, failed_construction_hands_the_flag_to_a_waiter)
+{
+    di::add<flaky>();
+
+    std::atomic<int> failures{ 0 };
+    std::vector<flaky*> seen(threads, nullptr);
+    race([&](std::size_t i)
+    {
+        try
+        {
+            seen[i] = di::get_ptr<flaky>();
+        }
+        catch (const std::runtime_error&)
+        {
+            failures.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    EXPECT_EQ(failures.load(), 1);
+    EXPECT_EQ(flaky::attempts.load(), 2);
+
+    flaky* instance = di::get_ptr<flaky>();
+    for (auto ptr : seen)
+    {
+        EXPECT_TRUE(ptr == nullptr || ptr == instance);
+    }
+}
+
+TEST(once_init, per_type_state_fills_whole_cache_lines)
+{
+    EXPECT_EQ(alignof(internal::cache_line<internal::once_flag>), 64u);
+    EXPECT_EQ(sizeof(internal::cache_line<internal::once_flag>) % 64, 0u);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <memory>
+
+using namespace cpp_di;
+
+namespace
+{
+    struct counter
+    {
+        using pointer_policy = local_ownership;
+
+        int value = 3;
+    };
+
+    struct reader
+    {
+        using pointer_policy = local_ownership;
+
+        local_ptr<counter> source;
+
+        reader(local_ptr<counter> source) : source(std::move(source)) {}
+    };
+
+    struct request
+    {
+        using pointer_policy = local_ownership;
+    };
+
+    struct engine
+    {
+        using pointer_policy = unique_ownership;
+
+        int value = 5;
+    };
+
+    struct tracked : intrusive_base
+    {
+        using pointer_policy = intrusive_ownership;
+    };
+
+    // A shared_ownership dependent of a local_ownership type, both held by the container.
+    struct front
+    {
+        local_ptr<counter> source;
+
+        front(local_ptr<counter> source) : source(std::move(source)) {}
+    };
+}
+
+TEST(ownership, containers_hold_local_ownership_types)
+{
+    di::container c;
+    c.add<counter>();
+    c.add<reader>();
+    c.add<front>();
+
+    auto r = c.get<reader>();
+    ASSERT_TRUE(r);
+    EXPECT_EQ(r->source.get(), c.get_ptr<counter>());
+    EXPECT_EQ(r->source->value, 3);
+    EXPECT_EQ(c.get<front>()->source.get(), c.get_ptr<counter>());
+    EXPECT_EQ(c.get_ptr<reader>(), r.get());
+}
+
+TEST(ownership, containers_build_local_ownership_transients)
+{
+    di::container c;
+    c.add_transient<request>();
+
+    auto first = c.get<request>();
+    auto second = c.get<request>();
+    EXPECT_NE(first.get(), second.get());
+}
+
+TEST(ownership, containers_hold_unique_and_intrusive_ownership_types)
+{
+    di::container c;
+    c.add<engine>();
+    c.add<tracked>();
+
+    EXPECT_EQ(c.get<engine>(), c.get_ptr<engine>());
+    EXPECT_EQ(c.get<engine>()->value, 5);
+    EXPECT_EQ(c.get<tracked>().get(), c.get_ptr<tracked>());
+}
+
+// Containers are independent: each builds its own instance of a local_ownership type.
+TEST(ownership, containers_do_not_share_local_instances)
+{
+    di::container first;
+    di::container second;
+    first.add<counter>();
+    second.add<counter>();
+
+    EXPECT_NE(first.get_ptr<counter>(), second.get_ptr<counter>());
+}
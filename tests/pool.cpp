@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace cpp_di;
+
+namespace
+{
+    // Counts the instances built and alive, and flags the ones currently handed out.
+    template<int N>
+    struct parser
+    {
+        inline static std::atomic<int> built{ 0 };
+        inline static std::atomic<int> alive{ 0 };
+
+        std::atomic<bool> held{ false };
+        int uses = 0;
+
+        parser()
+        {
+            built.fetch_add(1, std::memory_order_relaxed);
+            alive.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ~parser()
+        {
+            alive.fetch_sub(1, std::memory_order_relaxed);
+        }
+    };
+
+    using recycled = parser<0>;
+    using prefilled = parser<1>;
+    using bounded = parser<2>;
+    using shared = parser<3>;
+}
+
+TEST(pool, released_instances_are_recycled_and_reset)
+{
+    di::add_pooled<recycled>({}, +[](recycled& p) { p.uses = 0; });
+
+    recycled* first = nullptr;
+    {
+        auto p = di::acquire<recycled>();
+        first = p.get();
+        p->uses = 3;
+    }
+
+    auto p = di::acquire<recycled>();
+    EXPECT_EQ(p.get(), first);
+    EXPECT_EQ(p->uses, 0);
+    EXPECT_EQ(recycled::built.load(), 1);
+}
+
+TEST(pool, prefill_is_built_on_first_acquire)
+{
+    di::add_pooled<prefilled>({ 8, 4 });
+    EXPECT_EQ(prefilled::built.load(), 0);
+
+    std::vector<pooled<prefilled>> held;
+    for (int i = 0; i < 4; i++)
+    {
+        held.push_back(di::acquire<prefilled>());
+    }
+    EXPECT_EQ(prefilled::built.load(), 4);
+
+    held.push_back(di::acquire<prefilled>());
+    EXPECT_EQ(prefilled::built.load(), 5);
+}
+
+// Instances given back while every slot is taken are destroyed. Capacity is split evenly
+// across the shards, so it may round up by less than one instance per shard.
+TEST(pool, idle_instances_are_bounded_by_capacity)
+{
+    constexpr std::size_t capacity = 4;
+    di::add_pooled<bounded>({ capacity, 0 });
+
+    {
+        std::vector<pooled<bounded>> held;
+        for (int i = 0; i < 32; i++)
+        {
+            held.push_back(di::acquire<bounded>());
+        }
+        EXPECT_EQ(bounded::alive.load(), 32);
+    }
+
+    std::size_t shards = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, capacity);
+    std::size_t rounded = (capacity + shards - 1) / shards * shards;
+    EXPECT_GE(static_cast<std::size_t>(bounded::alive.load()), capacity);
+    EXPECT_LE(static_cast<std::size_t>(bounded::alive.load()), rounded);
+}
+
+// No instance is ever handed to two threads at once.
+TEST(pool, concurrent_acquire_never_shares_an_instance)
+{
+    constexpr int threads = 8;
+    constexpr int rounds = 20000;
+    di::add_pooled<shared>({ 16, 0 });
+
+    std::atomic<int> overlaps{ 0 };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&]()
+        {
+            for (int i = 0; i < rounds; i++)
+            {
+                auto p = di::acquire<shared>();
+                if (p->held.exchange(true, std::memory_order_acq_rel))
+                {
+                    overlaps.fetch_add(1, std::memory_order_relaxed);
+                }
+                p->uses++;
+                p->held.store(false, std::memory_order_release);
+            }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    EXPECT_EQ(overlaps.load(), 0);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <atomic>
+
+using namespace cpp_di;
+
+namespace
+{
+    // Leaves count every reference operation made on them through their own
+    // intrusive_add_ref / intrusive_release, so the wiring path can be audited exactly.
+    template<int N, bool TRANSIENT>
+    struct leaf
+    {
+        using pointer_policy = intrusive_ownership;
+
+        inline static std::atomic<int> add_refs{ 0 };
+        inline static std::atomic<int> releases{ 0 };
+
+        mutable std::atomic<int> references{ 0 };
+
+        friend void intrusive_add_ref(const leaf* ptr) noexcept
+        {
+            add_refs.fetch_add(1, std::memory_order_relaxed);
+            ptr->references.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        friend void intrusive_release(const leaf* ptr) noexcept
+        {
+            releases.fetch_add(1, std::memory_order_relaxed);
+            if (ptr->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete ptr;
+            }
+        }
+    };
+
+    template<bool TRANSIENT>
+    struct root
+    {
+        using pointer_policy = intrusive_ownership;
+
+        intrusive_ptr<leaf<0, TRANSIENT>> l0; intrusive_ptr<leaf<1, TRANSIENT>> l1;
+        intrusive_ptr<leaf<2, TRANSIENT>> l2; intrusive_ptr<leaf<3, TRANSIENT>> l3;
+        intrusive_ptr<leaf<4, TRANSIENT>> l4; intrusive_ptr<leaf<5, TRANSIENT>> l5;
+        intrusive_ptr<leaf<6, TRANSIENT>> l6; intrusive_ptr<leaf<7, TRANSIENT>> l7;
+
+        mutable std::atomic<int> references{ 0 };
+
+        root(intrusive_ptr<leaf<0, TRANSIENT>> l0, intrusive_ptr<leaf<1, TRANSIENT>> l1,
+             intrusive_ptr<leaf<2, TRANSIENT>> l2, intrusive_ptr<leaf<3, TRANSIENT>> l3,
+             intrusive_ptr<leaf<4, TRANSIENT>> l4, intrusive_ptr<leaf<5, TRANSIENT>> l5,
+             intrusive_ptr<leaf<6, TRANSIENT>> l6, intrusive_ptr<leaf<7, TRANSIENT>> l7)
+            : l0(std::move(l0)), l1(std::move(l1)), l2(std::move(l2)), l3(std::move(l3))
+            , l4(std::move(l4)), l5(std::move(l5)), l6(std::move(l6)), l7(std::move(l7))
+        {
+        }
+
+        friend void intrusive_add_ref(const root* ptr) noexcept
+        {
+            ptr->references.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        friend void intrusive_release(const root* ptr) noexcept
+        {
+            if (ptr->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete ptr;
+            }
+        }
+    };
+
+    using singleton_root = root<false>;
+    using transient_root = root<true>;
+
+    template<bool TRANSIENT, int... N>
+    void expect_counts(std::integer_sequence<int, N...>, int add_refs, int releases)
+    {
+        auto expect = [&](int n, int leaf_add_refs, int leaf_releases)
+        {
+            EXPECT_EQ(leaf_add_refs, add_refs) << "leaf " << n;
+            EXPECT_EQ(leaf_releases, releases) << "leaf " << n;
+        };
+        (expect(N, leaf<N, TRANSIENT>::add_refs.load(), leaf<N, TRANSIENT>::releases.load()), ...);
+    }
+
+    template<bool TRANSIENT, int... N>
+    void register_leaves(std::integer_sequence<int, N...>)
+    {
+        if constexpr (TRANSIENT)
+        {
+            (di::add_transient<leaf<N, TRANSIENT>>(), ...);
+        }
+        else
+        {
+            (di::add<leaf<N, TRANSIENT>>(), ...);
+        }
+    }
+}
+
+// A singleton leaf is referenced once by its registry and once by the root member; the
+// argument is moved all the way from resolution into the constructor, so nothing is
+// copied and nothing is released.
+TEST(refcount, wide_singleton_graph_moves_every_dependency)
+{
+    register_leaves<false>(std::make_integer_sequence<int, 8>());
+    di::add<singleton_root>();
+
+    auto r = di::get<singleton_root>();
+    ASSERT_TRUE(r);
+
+    expect_counts<false>(std::make_integer_sequence<int, 8>(), 2, 0);
+}
+
+// A transient leaf is owned by the root member alone.
+TEST(refcount, wide_transient_graph_moves_every_dependency)
+{
+    register_leaves<true>(std::make_integer_sequence<int, 8>());
+    di::add_transient<transient_root>();
+
+    auto r = di::get<transient_root>();
+    ASSERT_TRUE(r);
+
+    expect_counts<true>(std::make_integer_sequence<int, 8>(), 1, 0);
+
+    r.reset();
+    expect_counts<true>(std::make_integer_sequence<int, 8>(), 1, 1);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace cpp_di;
+
+namespace
+{
+    std::vector<const char*> destroyed;
+
+    struct table { ~table() { destroyed.push_back("table"); } };
+
+    struct lookup
+    {
+        std::shared_ptr<table> t;
+
+        lookup(std::shared_ptr<table> t) : t(std::move(t)) {}
+        ~lookup() { destroyed.push_back("lookup"); }
+    };
+
+    const service_info& find(const std::vector<service_info>& services, lifetime kind)
+    {
+        return *std::find_if(services.begin(), services.end(), [&](const service_info& s) { return s.kind == kind; });
+    }
+}
+
+TEST(replicated, replicas_are_reported_and_released_by_shutdown)
+{
+    di::add<table>();
+    di::add_replicated<lookup>();
+
+    EXPECT_FALSE(find(di::report(), lifetime::replicated).constructed);
+
+    auto replica = di::get_ptr<lookup>();
+    EXPECT_EQ(di::get_ptr<lookup>(), replica);
+    EXPECT_EQ(replica->t, di::get<table>());
+
+    auto services = di::report();
+    EXPECT_TRUE(find(services, lifetime::replicated).constructed);
+    EXPECT_GE(find(services, lifetime::replicated).use_count, 1);
+
+    di::shutdown();
+
+    ASSERT_EQ(destroyed.size(), 2u);
+    EXPECT_STREQ(destroyed[0], "lookup");
+    EXPECT_STREQ(destroyed[1], "table");
+    EXPECT_FALSE(find(di::report(), lifetime::replicated).constructed);
+}
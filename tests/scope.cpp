@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+using namespace cpp_di;
+
+namespace
+{
+    // Counts its live instances.
+    template<int N>
+    struct request
+    {
+        inline static std::atomic<int> alive{ 0 };
+
+        int id = 0;
+
+        request() { alive.fetch_add(1, std::memory_order_relaxed); }
+        ~request() { alive.fetch_sub(1, std::memory_order_relaxed); }
+    };
+
+    struct database {};
+
+    // Transient handler of a scoped request, wired to a singleton as well.
+    struct handler
+    {
+        std::shared_ptr<request<0>> current;
+        std::shared_ptr<database> db;
+
+        handler(std::shared_ptr<request<0>> current, std::shared_ptr<database> db)
+            : current(std::move(current)), db(std::move(db))
+        {
+        }
+    };
+
+    const bool registered = []
+    {
+        di::add_scoped<request<0>>();
+        di::add_scoped<request<1>>();
+        di::add_scoped<request<2>>();
+        di::add<database>();
+        di::add_transient<handler>();
+        return true;
+    }();
+}
+
+TEST(scope, one_instance_per_scope)
+{
+    ASSERT_TRUE(registered);
+
+    di::scope first;
+    di::scope second;
+
+    auto a = first.get<request<0>>();
+    EXPECT_EQ(a, first.get<request<0>>());
+    EXPECT_NE(a, second.get<request<0>>());
+}
+
+TEST(scope, dependencies_resolve_in_the_same_scope)
+{
+    di::scope s;
+
+    auto h = s.get<handler>();
+    EXPECT_EQ(h->current, s.get<request<0>>());
+    EXPECT_EQ(h->db, di::get<database>());
+}
+
+TEST(scope, instances_end_with_their_scope)
+{
+    {
+        di::scope s;
+        s.get<request<1>>();
+        EXPECT_EQ(request<1>::alive.load(), 1);
+    }
+    EXPECT_EQ(request<1>::alive.load(), 0);
+}
+
+TEST(scope, allocates_from_a_caller_buffer)
+{
+    alignas(std::max_align_t) std::byte buffer[512];
+    di::scope s(buffer, sizeof(buffer));
+
+    auto r = s.get<request<2>>();
+    auto address = reinterpret_cast<const std::byte*>(r.get());
+    EXPECT_GE(address, buffer);
+    EXPECT_LT(address, buffer + sizeof(buffer));
+}
+
+TEST(scope, scoped_types_outside_of_a_scope_raise)
+{
+    try
+    {
+        di::get<request<0>>();
+        FAIL() << "a scoped type resolved outside of a scope";
+    }
+    catch (const error& e)
+    {
+        EXPECT_EQ(e.code(), errc::outside_scope);
+    }
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace cpp_di;
+
+namespace
+{
+    std::mutex destroyed_lock;
+    std::vector<std::string> destroyed;
+    int watched = -1;
+
+    // shutdown and warm_up reach the graphs of every test run so far, so only the
+    // destructions of the graph under test are recorded.
+    void watch(int graph)
+    {
+        std::lock_guard lock(destroyed_lock);
+        destroyed.clear();
+        watched = graph;
+    }
+
+    void record(int graph, std::string name)
+    {
+        std::lock_guard lock(destroyed_lock);
+        if (graph == watched)
+        {
+            destroyed.push_back(std::move(name));
+        }
+    }
+
+    std::size_t position(const std::string& name)
+    {
+        return static_cast<std::size_t>(std::find(destroyed.begin(), destroyed.end(), name) - destroyed.begin());
+    }
+
+    // storage <- cache <- api, and storage <- metrics alongside. Every test builds its own
+    // graph, N, since a registry that has been shut down stays empty.
+    template<int N>
+    struct storage { ~storage() { record(N, "storage"); } };
+
+    template<int N>
+    struct cache
+    {
+        std::shared_ptr<storage<N>> s;
+
+        cache(std::shared_ptr<storage<N>> s) : s(std::move(s)) {}
+        ~cache() { record(N, "cache"); }
+    };
+
+    template<int N>
+    struct api
+    {
+        std::shared_ptr<cache<N>> c;
+
+        api(std::shared_ptr<cache<N>> c) : c(std::move(c)) {}
+        ~api() { record(N, "api"); }
+    };
+
+    template<int N>
+    struct metrics
+    {
+        std::shared_ptr<storage<N>> s;
+
+        metrics(std::shared_ptr<storage<N>> s) : s(std::move(s)) {}
+        ~metrics() { record(N, "metrics"); }
+    };
+
+    template<int N>
+    struct disposable
+    {
+        static constexpr bool trivially_disposable = true;
+
+        ~disposable() { record(N, "disposable"); }
+    };
+
+    void expect_reverse_topological()
+    {
+        ASSERT_EQ(destroyed.size(), 4u);
+        EXPECT_LT(position("api"), position("cache"));
+        EXPECT_LT(position("cache"), position("storage"));
+        EXPECT_LT(position("metrics"), position("storage"));
+    }
+}
+
+// Dependents are registered first, so reversing the registration order would destroy storage
+// before anything that uses it. Registered in each test body rather than from a template, so
+// that di::get sees the types.
+
+TEST(shutdown, releases_dependents_before_their_dependencies)
+{
+    watch(0);
+    di::add<api<0>>();
+    di::add<metrics<0>>();
+    di::add<cache<0>>();
+    di::add<storage<0>>();
+    di::get<metrics<0>>();
+    di::get<api<0>>();
+
+    di::shutdown();
+
+    expect_reverse_topological();
+    EXPECT_FALSE(di::get<api<0>>());
+}
+
+TEST(shutdown, parallel_teardown_keeps_the_order)
+{
+    watch(1);
+    di::add<api<1>>();
+    di::add<metrics<1>>();
+    di::add<cache<1>>();
+    di::add<storage<1>>();
+    di::warm_up(4);
+
+    di::shutdown(4);
+
+    expect_reverse_topological();
+}
+
+TEST(shutdown, fast_exit_leaks_trivially_disposable_instances)
+{
+    watch(2);
+    di::add<api<2>>();
+    di::add<metrics<2>>();
+    di::add<cache<2>>();
+    di::add<storage<2>>();
+    di::add<disposable<2>>();
+    di::warm_up(1);
+
+    di::shutdown(shutdown_mode::fast_exit);
+
+    EXPECT_EQ(position("disposable"), destroyed.size());
+    expect_reverse_topological();
+}
+
+TEST(shutdown, instances_held_elsewhere_outlive_their_registry)
+{
+    watch(3);
+    di::add<api<3>>();
+    di::add<metrics<3>>();
+    di::add<cache<3>>();
+    di::add<storage<3>>();
+    auto held = di::get<cache<3>>();
+
+    di::shutdown();
+
+    EXPECT_TRUE(destroyed.empty());
+    held.reset();
+    EXPECT_EQ(destroyed, (std::vector<std::string>{ "cache", "storage" }));
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <cpp_di.hpp>
+
+#include <memory>
+#include <stdexcept>
+
+using namespace cpp_di;
+
+// Built twice: as is, and with -fno-exceptions, where failures of nested dependencies reach
+// try_get through internal::fail instead of unwinding.
+
+namespace
+{
+    struct config { int value = 7; };
+
+    struct service
+    {
+        std::shared_ptr<config> cfg;
+
+        service(std::shared_ptr<config> cfg) : cfg(std::move(cfg)) {}
+    };
+
+    // Each test that registers a missing dependency, or relies on it staying missing, uses
+    // its own N so that the tests pass in any order.
+    template<int N>
+    struct unregistered { int value = 0; };
+
+    template<int N>
+    struct orphan
+    {
+        orphan(std::shared_ptr<unregistered<N>>) {}
+    };
+
+    template<int N>
+    struct borrows_orphan
+    {
+        using inject = std::tuple<unregistered<N>&>;
+
+        borrows_orphan(unregistered<N>&) {}
+    };
+
+    struct session { int id = 0; };
+
+    struct handler
+    {
+        handler(std::shared_ptr<session>) {}
+    };
+
+    struct buffer { char data[64]{}; };
+
+    const bool registered = []
+    {
+        di::add<config>();
+        di::add<service>();
+        di::add<orphan<0>>();
+        di::add<borrows_orphan<0>>();
+        di::add<orphan<1>>();
+        di::add<borrows_orphan<1>>();
+        di::add<orphan<2>>();
+        di::add_scoped<session>();
+        di::add_transient<handler>();
+        di::add_pooled<buffer>();
+        return true;
+    }();
+}
+
+TEST(try_get, resolves_registered_graphs)
+{
+    ASSERT_TRUE(registered);
+
+    auto r = di::try_get<service>();
+    ASSERT_TRUE(r);
+    EXPECT_EQ(r.error(), errc::none);
+    EXPECT_EQ((*r)->cfg->value, 7);
+    EXPECT_EQ(r->get(), di::get<service>().get());
+}
+
+TEST(try_get, reports_a_missing_dependency)
+{
+    auto r = di::try_get<orphan<0>>();
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.error(), errc::not_registered);
+}
+
+TEST(try_get, reports_a_missing_reference_dependency)
+{
+    auto r = di::try_get<borrows_orphan<0>>();
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.error(), errc::not_registered);
+}
+
+TEST(try_get, reports_a_scoped_dependency_outside_of_a_scope)
+{
+    auto r = di::try_get<handler>();
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.error(), errc::outside_scope);
+}
+
+TEST(try_get, reports_a_pooled_type_resolved_through_get)
+{
+    auto r = di::try_get<buffer>();
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.error(), errc::wrong_lifetime);
+}
+
+// A failed construction is not remembered: once the dependency exists, resolution succeeds.
+TEST(try_get, failures_leave_the_registration_usable)
+{
+    EXPECT_EQ(di::try_get<orphan<1>>().error(), errc::not_registered);
+
+    di::add<unregistered<1>>();
+    EXPECT_TRUE(di::try_get<orphan<1>>());
+    EXPECT_TRUE(di::try_get<borrows_orphan<1>>());
+}
+
+#ifndef CPP_DI_NO_EXCEPTIONS
+namespace
+{
+    struct throwing
+    {
+        throwing() { throw std::runtime_error("construction failed"); }
+    };
+}
+
+TEST(try_get, reports_a_throwing_constructor)
+{
+    di::add<throwing>();
+
+    auto r = di::try_get<throwing>();
+    EXPECT_FALSE(r);
+    EXPECT_EQ(r.error(), errc::construction_failed);
+}
+
+TEST(try_get, value_of_a_failure_raises)
+{
+    auto r = di::try_get<orphan<2>>();
+    try
+    {
+        r.value();
+        FAIL() << "value() returned";
+    }
+    catch (const error& e)
+    {
+        EXPECT_EQ(e.code(), errc::not_registered);
+    }
+}
+#endif